@@ -0,0 +1,103 @@
+#include "snake_batch.h"
+
+/// plays many ai games across every core and prints the spread of results.
+/// usage: snake-batch [games] [threads] [seed] [size] [greedy|room|path|cycle]
+
+static int compare_double(const void * a, const void * b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/// sorts values in place.
+static void print_distribution(const char * name, double * values, const uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    qsort(values, count, sizeof(double), compare_double);
+
+    double sum = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sum += values[i];
+    }
+
+    printf("%-12s %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", name,
+        values[0], sum / count,
+        values[count / 2], values[(uint64_t)count * 90 / 100], values[(uint64_t)count * 99 / 100],
+        values[count - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+    batch_config_t config = {0};
+    config.games = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    config.threads = argc > 2 ? strtoul(argv[2], NULL, 10) : 0;
+    const uint64_t seed = snake_parse_seed(argc, argv, 3);
+    config.rows = config.columns = argc > 4 ? strtoul(argv[4], NULL, 10) : 20;
+    config.player = Player_AI;
+    if (argc > 5 && strcmp(argv[5], "room") == 0) config.player = Player_ROOM;
+    if (argc > 5 && strcmp(argv[5], "path") == 0) config.player = Player_PATH;
+    if (argc > 5 && strcmp(argv[5], "cycle") == 0) config.player = Player_CYCLE;
+    config.tick_limit = 100000;
+    config.item_goal = 1;
+    config.seed = seed;
+
+    batch_result_t result;
+    if (snake_batch_run(&config, &result))
+    {
+        fprintf(stderr, "failed to start the worker threads\n");
+        return 1;
+    }
+
+    printf("seed:        %llu\n", (unsigned long long)seed);
+    printf("games:       %u\n", result.game_count);
+    printf("threads:     %u\n", result.threads);
+    printf("steals:      %llu\n", (unsigned long long)result.steals);
+    printf("ticks:       %llu\n", (unsigned long long)result.ticks);
+    printf("elapsed:     %.3fs\n", result.elapsed);
+    printf("ticks/sec:   %.0f\n\n", result.elapsed > 0 ? result.ticks / result.elapsed : 0.0);
+
+    const uint32_t count = result.game_count ? result.game_count : 1;
+    double *score = calloc(count, sizeof(double));
+    double *length = calloc(count, sizeof(double));
+    double *ticks = calloc(count, sizeof(double));
+    double *rate = calloc(count, sizeof(double));
+    assert(score); assert(length); assert(ticks); assert(rate);
+
+    /// fnv-1a over every game's outcome, equal seeds must give equal sums
+    /// whatever the thread count.
+    uint64_t checksum = 0xCBF29CE484222325ULL;
+
+    for (uint32_t i = 0; i < result.game_count; i++)
+    {
+        checksum = (checksum ^ result.games[i].ticks) * 0x100000001B3ULL;
+        checksum = (checksum ^ result.games[i].score) * 0x100000001B3ULL;
+        checksum = (checksum ^ result.games[i].size) * 0x100000001B3ULL;
+
+        score[i] = result.games[i].score;
+        length[i] = result.games[i].size;
+        ticks[i] = result.games[i].ticks;
+        rate[i] = result.games[i].ticks_per_sec;
+    }
+
+    printf("checksum:    %016llx\n\n", (unsigned long long)checksum);
+
+    printf("%-12s %12s %12s %12s %12s %12s %12s\n", "", "min", "mean", "p50", "p90", "p99", "max");
+    print_distribution("score", score, result.game_count);
+    print_distribution("length", length, result.game_count);
+    print_distribution("ticks", ticks, result.game_count);
+    print_distribution("ticks/sec", rate, result.game_count);
+
+    free(score);
+    free(length);
+    free(ticks);
+    free(rate);
+    snake_batch_free(&result);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,753 @@
+#include "snake_core.h"
+#include "snake_raster.h"
+#include "snake_mcts.h"
+#include "snake_env.h"
+
+/// micro benchmarks for the core, run with no renderer attached.
+/// usage: snake-bench [name]
+
+typedef struct
+{
+    const char *name;
+    void (*func)(void);
+} bench_t;
+
+/// plays ai games on a size x size board until ticks moves have run.
+static void bench_tick_size(const uint16_t size, const uint64_t ticks)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+
+    uint64_t done = 0;
+    uint32_t games = 0;
+
+    const double start = snake_get_time();
+
+    while (done < ticks)
+    {
+        snake_new_game(game, games);
+        game->state = GameState_PLAY;
+        game->player_type = Player_AI;
+        games++;
+
+        while (!game->game_over && done < ticks)
+        {
+            snake_step(game);
+            done++;
+        }
+    }
+
+    const double elapsed = snake_get_time() - start;
+
+    printf("tick %3ux%-3u  %8.2f ns/tick  %6u games\n", size, size, elapsed * 1e9 / done, games);
+
+    snake_exit(game);
+}
+
+static void bench_tick(void)
+{
+    bench_tick_size(20, 20000000);
+    bench_tick_size(255, 20000000);
+}
+
+/// the old way of spawning, kept here to compare against.
+static void spawn_rejection(board_t * board, rng_t * rng)
+{
+    uint16_t x = 0, y = 0;
+    do
+    {
+        x = rng_range(rng, board->rows);
+        y = rng_range(rng, board->columns);
+    } while (board_get(board, x, y) != BoardCellType_EMPTY);
+
+    board_set(board, x, y, BoardCellType_ITEM);
+    board->items[0].x = x;
+    board->items[0].y = y;
+}
+
+/// fills a size x size board until 1% of the playable cells are empty,
+/// then times spawning (and removing) an item.
+static void bench_spawn_size(const uint16_t size, const uint32_t spawns)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+    snake_new_game(game, 1);
+
+    board_t *board = game->board;
+    const uint32_t target = (board->rows - 2) * (board->columns - 2) / 100;
+
+    for (uint16_t x = 0; x < board->rows && board->free_count > target; x++)
+    {
+        for (uint16_t y = 0; y < board->columns && board->free_count > target; y++)
+        {
+            if (board_get(board, x, y) == BoardCellType_EMPTY)
+            {
+                board_set(board, x, y, BoardCellType_SNAKEBODY);
+            }
+        }
+    }
+
+    double start = snake_get_time();
+    for (uint32_t i = 0; i < spawns; i++)
+    {
+        board_gen_rand_item_pos(board, &game->rng, ItemType_FOOD);
+        const board_item_t item = board_remove_item(board, board->items[0].x, board->items[0].y);
+        board_set(board, item.x, item.y, BoardCellType_EMPTY);
+    }
+    const double indexed = snake_get_time() - start;
+
+    start = snake_get_time();
+    for (uint32_t i = 0; i < spawns; i++)
+    {
+        spawn_rejection(board, &game->rng);
+        board_set(board, board->items[0].x, board->items[0].y, BoardCellType_EMPTY);
+    }
+    const double rejection = snake_get_time() - start;
+
+    /// the count board_set keeps against the bitset, after all that churn.
+    printf("spawn %3ux%-3u %5u free  %8.2f ns indexed  %8.2f ns rejection  %s\n",
+        size, size, board->free_count, indexed * 1e9 / spawns, rejection * 1e9 / spawns,
+        board_free_count(board) == board->free_count ? "ok" : "free count WRONG");
+
+    snake_exit(game);
+}
+
+static void bench_spawn(void)
+{
+    bench_spawn_size(20, 100000);
+    bench_spawn_size(255, 100000);
+}
+
+/// plays until the game over the same ticks twice, once from a restore,
+/// and checks both end up the same.
+static bool snapshot_check(game_t * game, void * buffer, const uint32_t ticks)
+{
+    snake_snapshot(game, buffer);
+
+    for (uint32_t i = 0; i < ticks && !game->game_over; i++)
+    {
+        snake_step(game);
+    }
+
+    const uint32_t score = game->board->score;
+    const uint32_t size = game->snake->size;
+    const snake_body_t head = game->snake->body[game->snake->h_pos];
+
+    snake_restore(game, buffer);
+
+    for (uint32_t i = 0; i < ticks && !game->game_over; i++)
+    {
+        snake_step(game);
+    }
+
+    const snake_body_t new_head = game->snake->body[game->snake->h_pos];
+
+    return score == game->board->score && size == game->snake->size && \
+        head.x == new_head.x && head.y == new_head.y;
+}
+
+/// the same, but going back through the board's journal with snake_rewind.
+static bool rewind_check(game_t * game, void * buffer, const uint32_t ticks)
+{
+    snake_restore(game, buffer);
+
+    for (uint32_t i = 0; i < ticks && !game->game_over; i++)
+    {
+        snake_step(game);
+    }
+
+    const uint32_t score = game->board->score;
+    const uint32_t size = game->snake->size;
+    const snake_body_t head = game->snake->body[game->snake->h_pos];
+
+    snake_rewind(game, buffer);
+
+    for (uint32_t i = 0; i < ticks && !game->game_over; i++)
+    {
+        snake_step(game);
+    }
+
+    const snake_body_t new_head = game->snake->body[game->snake->h_pos];
+
+    return score == game->board->score && size == game->snake->size && \
+        head.x == new_head.x && head.y == new_head.y;
+}
+
+static void bench_snapshot_size(const uint16_t size, const uint32_t count)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+    game->player_type = Player_AI;
+
+    /// get a few items in so the snake isn't at its starting size.
+    uint64_t seed = 1;
+    do
+    {
+        snake_new_game(game, seed++);
+        for (uint32_t i = 0; i < 2000 && !game->game_over; i++)
+        {
+            snake_step(game);
+        }
+    } while (game->game_over);
+
+    void *buffer = malloc(snake_snapshot_size(game));
+    assert(buffer);
+
+    size_t bytes = 0;
+
+    double start = snake_get_time();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bytes = snake_snapshot(game, buffer);
+    }
+    const double snapshot = snake_get_time() - start;
+
+    start = snake_get_time();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        snake_restore(game, buffer);
+    }
+    const double restore = snake_get_time() - start;
+
+    /// as mcts uses it, a few ticks played between each rewind.
+    game->board->journal_max = 4 * 64;
+    game->board->journal = malloc(game->board->journal_max * sizeof(board_change_t));
+    assert(game->board->journal);
+
+    snake_restore(game, buffer);
+    start = snake_get_time();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (uint32_t t = 0; t < 4 && !game->game_over; t++)
+        {
+            snake_step(game);
+        }
+        snake_rewind(game, buffer);
+    }
+    const double rewind = snake_get_time() - start;
+
+    const bool ok = snapshot_check(game, buffer, 1000) && rewind_check(game, buffer, 60);
+
+    printf("snapshot %3ux%-3u %7zu bytes  %10.0f snapshots/sec  %10.0f restores/sec  %10.0f rewinds/sec (4 ticks)  %s\n",
+        size, size, bytes, count / snapshot, count / restore, count / rewind, ok ? "ok" : "MISMATCH");
+
+    free(game->board->journal);
+    game->board->journal = NULL;
+    free(buffer);
+    snake_exit(game);
+}
+
+static void bench_snapshot(void)
+{
+    bench_snapshot_size(20, 1000000);
+    bench_snapshot_size(128, 20000);
+}
+
+/// cost of starting a game, what short back to back ai games pay each time.
+static void bench_new_game_size(const uint16_t size, const uint32_t count)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+
+    const double start = snake_get_time();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        snake_new_game(game, i);
+    }
+    const double elapsed = snake_get_time() - start;
+
+    printf("new game %3ux%-3u %10.2f ns/game\n", size, size, elapsed * 1e9 / count);
+
+    snake_exit(game);
+}
+
+static void bench_new_game(void)
+{
+    bench_new_game_size(20, 1000000);
+    bench_new_game_size(128, 10000);
+    /// every cell is written, so this is what a huge board pays per game.
+    bench_new_game_size(4096, 10);
+}
+
+/// cpu raster of a size x size board at scale, every cell and then
+/// only the cells each tick changes.
+static void bench_raster_size(const uint16_t size, const uint32_t scale, const uint32_t frames)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+    snake_new_game(game, 1);
+    game->state = GameState_PLAY;
+    game->player_type = Player_AI;
+
+    uint32_t palette[256];
+    raster_palette_default(palette);
+
+    framebuffer_t fb;
+    const int err = framebuffer_create(&fb, size * scale, size * scale);
+    assert(err == 0); (void)err;
+
+    double start = snake_get_time();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        game->board->dirty_all = true;
+        raster_board(&fb, game->board, palette, scale);
+    }
+    const double full = snake_get_time() - start;
+
+    /// ticks are timed too, take them off using a run without the raster.
+    start = snake_get_time();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        if (game->game_over)
+        {
+            snake_new_game(game, i);
+            game->state = GameState_PLAY;
+        }
+        snake_step(game);
+        raster_board(&fb, game->board, palette, scale);
+    }
+    const double with_raster = snake_get_time() - start;
+
+    snake_new_game(game, 1);
+    game->state = GameState_PLAY;
+    start = snake_get_time();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        if (game->game_over)
+        {
+            snake_new_game(game, i);
+            game->state = GameState_PLAY;
+        }
+        snake_step(game);
+        board_clear_dirty(game->board);
+    }
+    const double without_raster = snake_get_time() - start;
+
+    const double pixels = (double)fb.w * fb.h;
+    printf("raster %3ux%-3u x%-2u %10.2f us/full frame  %6.2f Gpixel/s  %8.2f ns/tick dirty\n", size, size, scale,
+        full * 1e6 / frames, pixels * frames / full / 1e9, (with_raster - without_raster) * 1e9 / frames);
+
+    framebuffer_free(&fb);
+    snake_exit(game);
+}
+
+/// cpu raster of a w x h view following the head of a size x size board,
+/// every cell in view and then what each tick changes, re-centres included.
+/// neither should grow with the board.
+static void bench_raster_view_size(const uint16_t size, const uint16_t w, const uint16_t h, const uint32_t scale, const uint32_t frames)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+    snake_new_game(game, 1);
+    game->state = GameState_PLAY;
+    game->player_type = Player_AI;
+
+    uint32_t palette[256];
+    raster_palette_default(palette);
+
+    framebuffer_t fb;
+    const int err = framebuffer_create(&fb, w * scale, h * scale);
+    assert(err == 0); (void)err;
+
+    raster_view_t view = {0};
+    const snake_body_t head = game->snake->body[game->snake->h_pos];
+    raster_view_follow(&view, game->board, w, h, head.x, head.y);
+
+    double start = snake_get_time();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        game->board->dirty_all = true;
+        raster_board_view(&fb, game->board, palette, scale, &view);
+    }
+    const double full = snake_get_time() - start;
+
+    /// timed around the raster alone, a big board's tick is slow enough
+    /// to drown it.
+    uint32_t moves = 0;
+    double following = 0;
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        if (game->game_over)
+        {
+            snake_new_game(game, i);
+            game->state = GameState_PLAY;
+        }
+        snake_step(game);
+
+        start = snake_get_time();
+        const snake_body_t head = game->snake->body[game->snake->h_pos];
+        if (raster_view_follow(&view, game->board, w, h, head.x, head.y))
+        {
+            game->board->dirty_all = true;
+            moves++;
+        }
+        raster_board_view(&fb, game->board, palette, scale, &view);
+        following += snake_get_time() - start;
+    }
+
+    printf("raster %4ux%-4u view %ux%u x%u %10.2f us/full view  %8.2f ns/tick following  %5.1f moves/ktick\n", size, size, w, h, scale,
+        full * 1e6 / frames, following * 1e9 / frames, moves * 1000.0 / frames);
+
+    framebuffer_free(&fb);
+    snake_exit(game);
+}
+
+static void bench_raster(void)
+{
+    bench_raster_size(20, 30, 20000);
+    bench_raster_size(255, 4, 2000);
+    bench_raster_view_size(255, 160, 120, 4, 20000);
+    bench_raster_view_size(1024, 160, 120, 4, 20000);
+    bench_raster_view_size(4096, 160, 120, 4, 20000);
+}
+
+/// plays the same seeds with each ai player, a decision is one tick's move.
+static void bench_ai_player(const char * name, const Player player, const uint16_t size, const uint32_t games, const uint32_t tick_limit)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+
+    uint64_t ticks = 0;
+    uint64_t score = 0;
+    uint32_t best = 0;
+    uint32_t limited = 0;
+    uint32_t filled = 0;
+    uint64_t fill_ticks = 0;
+
+    const double start = snake_get_time();
+
+    for (uint32_t g = 0; g < games; g++)
+    {
+        snake_new_game(game, g);
+        game->state = GameState_PLAY;
+        game->player_type = player;
+
+        uint32_t t = 0;
+        while (!game->game_over && t < tick_limit)
+        {
+            snake_step(game);
+            t++;
+        }
+
+        ticks += t;
+        score += game->board->score;
+        best = game->board->score > best ? game->board->score : best;
+        limited += !game->game_over;
+
+        /// game over with nothing left to eat or place, the board is full.
+        if (game->game_over && !game->board->free_count && !game->board->item_count)
+        {
+            filled++;
+            fill_ticks += t;
+        }
+    }
+
+    const double elapsed = snake_get_time() - start;
+
+    printf("ai %-7s %3ux%-3u %10.0f decisions/sec  %8.2f avg score  %5u best  %4u/%u hit tick limit  %4u/%u filled",
+        name, size, size, ticks / elapsed, (double)score / games, best, limited, games, filled, games);
+    printf(filled ? "  %8.0f avg ticks to fill\n" : "\n", filled ? (double)fill_ticks / filled : 0.0);
+
+    snake_exit(game);
+}
+
+static void bench_ai(void)
+{
+    bench_ai_player("greedy", Player_AI, 20, 1000, 100000);
+    bench_ai_player("room", Player_ROOM, 20, 1000, 100000);
+    bench_ai_player("path", Player_PATH, 20, 1000, 100000);
+    bench_ai_player("cycle", Player_CYCLE, 20, 1000, 100000);
+}
+
+/// the old way of sizing a region, kept here to compare against.
+static uint32_t region_flood(board_t * board, const uint32_t start, uint32_t * seen, uint32_t * queue, const uint32_t stamp)
+{
+    if (board_blocked(board, start))
+    {
+        return 0;
+    }
+
+    const int32_t offset[4] = { -(int32_t)board->stride, 1, board->stride, -1 };
+    uint32_t head = 0, tail = 0;
+
+    seen[start] = stamp;
+    queue[tail++] = start;
+
+    while (head < tail)
+    {
+        const uint32_t cell = queue[head++];
+
+        for (uint8_t d = 0; d < 4; d++)
+        {
+            const uint32_t next = cell + offset[d];
+            if (seen[next] != stamp && !board_blocked(board, next))
+            {
+                seen[next] = stamp;
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    return tail;
+}
+
+/// Player_ROOM games, every tick the room around the head is asked for both
+/// ways. the upkeep board_set spends keeping regions current shows in tick.
+static void bench_region_size(const uint16_t size, const uint64_t ticks)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+
+    const size_t cell_count = (size_t)(size + BOARD_PADDING * 2) * (size + BOARD_PADDING * 2);
+    uint32_t *seen = calloc(cell_count, sizeof(uint32_t));
+    uint32_t *queue = malloc(cell_count * sizeof(uint32_t));
+    assert(seen); assert(queue);
+
+    uint64_t done = 0;
+    uint64_t queries = 0;
+    uint64_t mismatches = 0;
+    uint64_t splits = 0;
+    uint64_t rebuilds = 0;
+    uint32_t stamp = 0;
+    uint32_t games = 0;
+    double query_time = 0;
+    double flood_time = 0;
+
+    while (done < ticks)
+    {
+        snake_new_game(game, games);
+        game->state = GameState_PLAY;
+        game->player_type = Player_ROOM;
+        games++;
+
+        board_t *board = game->board;
+
+        while (!game->game_over && done < ticks)
+        {
+            snake_step(game);
+            done++;
+
+            if (game->game_over)
+            {
+                break;
+            }
+
+            const snake_body_t head = game->snake->body[game->snake->h_pos];
+            const uint32_t at = board_bit_index(board, head.x, head.y);
+            const uint32_t cells[4] = { at - board->stride, at + 1, at + board->stride, at - 1 };
+            uint32_t room[4], flood[4];
+
+            double t = snake_get_time();
+            for (uint8_t d = 0; d < 4; d++)
+            {
+                room[d] = board_region_size(board, cells[d]);
+            }
+            query_time += snake_get_time() - t;
+
+            t = snake_get_time();
+            for (uint8_t d = 0; d < 4; d++)
+            {
+                flood[d] = region_flood(board, cells[d], seen, queue, ++stamp);
+            }
+            flood_time += snake_get_time() - t;
+
+            for (uint8_t d = 0; d < 4; d++)
+            {
+                mismatches += room[d] != flood[d];
+            }
+            queries += 4;
+        }
+
+        splits += board->region.splits;
+        rebuilds += board->region.rebuilds;
+    }
+
+    printf("region %3ux%-3u %8.2f ns/query  %10.2f ns/flood fill  %6.2f splits/ktick  %6.3f rebuilds/ktick  %llu/%llu wrong\n",
+        size, size, query_time * 1e9 / queries, flood_time * 1e9 / queries,
+        splits * 1e3 / done, rebuilds * 1e3 / done, (unsigned long long)mismatches, (unsigned long long)queries);
+
+    free(seen);
+    free(queue);
+    snake_exit(game);
+}
+
+static void bench_region(void)
+{
+    bench_region_size(20, 2000000);
+    bench_region_size(255, 200000);
+}
+
+/// a few games with every decision given budget seconds on every cpu.
+static void bench_mcts_budget(const uint16_t size, const double budget, const uint32_t games, const uint32_t tick_limit)
+{
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+
+    const mcts_config_t config = { .threads = 0, .budget = budget, .rollout_depth = 40, .seed = 1 };
+    game->mcts = mcts_create(&config);
+    if (!game->mcts)
+    {
+        printf("mcts %3ux%-3u %5.1fms  failed to start the worker threads\n", size, size, budget * 1e3);
+        snake_exit(game);
+        return;
+    }
+
+    uint64_t score = 0;
+    uint32_t died = 0;
+
+    for (uint32_t g = 0; g < games; g++)
+    {
+        snake_new_game(game, g);
+        game->state = GameState_PLAY;
+        game->player_type = Player_MCTS;
+
+        for (uint32_t t = 0; !game->game_over && t < tick_limit; t++)
+        {
+            snake_step(game);
+        }
+
+        score += game->board->score;
+        died += game->game_over && (game->board->free_count || game->board->item_count);
+    }
+
+    const mcts_stats_t *stats = &game->mcts->stats;
+    printf("mcts %3ux%-3u %5.1fms x %2u threads %10.0f rollouts/sec  %8.0f rollouts/decision  %6.1f avg score  %u/%u died  %llu/%llu late (worst %.1fus)\n",
+        size, size, budget * 1e3, game->mcts->worker_count, mcts_rollouts_per_sec(game->mcts), (double)stats->rollouts / stats->decisions,
+        (double)score / games, died, games, (unsigned long long)stats->overruns, (unsigned long long)stats->decisions, stats->overrun_max * 1e6);
+
+    mcts_destroy(game->mcts);
+    game->mcts = NULL;
+    snake_exit(game);
+}
+
+static void bench_mcts(void)
+{
+    bench_mcts_budget(20, 0.001, 4, 1500);
+    bench_mcts_budget(20, 0.005, 4, 1500);
+    /// restoring the root each rollout shouldn't grow with the board.
+    bench_mcts_budget(128, 0.005, 2, 300);
+}
+
+/// random actions into a batch of games, observations and all.
+static void bench_env_size(const uint16_t size, const uint32_t batch, const uint32_t steps)
+{
+    const env_config_t config = { .batch = batch, .rows = size, .columns = size, .item_goal = 1, .tick_limit = 1000 };
+
+    /// aligned as a tensor library would hand it over.
+    env_buffers_t out = {0};
+    out.obs = aligned_alloc(BOARD_ALIGN, (env_obs_size(&config) + BOARD_ALIGN - 1) / BOARD_ALIGN * BOARD_ALIGN);
+    out.reward = calloc(batch, sizeof(float));
+    out.done = calloc(batch, 1);
+    uint8_t *actions = calloc(batch, 1);
+    uint64_t *seeds = calloc(batch, sizeof(uint64_t));
+    assert(out.obs); assert(out.reward); assert(out.done); assert(actions); assert(seeds);
+
+    env_t *env = env_create(&config, &out);
+    assert(env);
+
+    for (uint32_t g = 0; g < batch; g++)
+    {
+        seeds[g] = g;
+    }
+
+    rng_t rng;
+    rng_seed(&rng, 1);
+    uint64_t episodes = 0;
+
+    const double start = snake_get_time();
+
+    const int err = env_reset(env, seeds);
+    assert(err == 0); (void)err;
+
+    for (uint32_t s = 0; s < steps; s++)
+    {
+        for (uint32_t g = 0; g < batch; g++)
+        {
+            actions[g] = rng_range(&rng, 4);
+        }
+
+        env_step(env, actions);
+
+        for (uint32_t g = 0; g < batch; g++)
+        {
+            episodes += out.done[g];
+        }
+    }
+
+    const double elapsed = snake_get_time() - start;
+
+    printf("env %3ux%-3u x %4u  %10.0f steps/sec  %8.2f ns/step  %8llu episodes  %6.1f MB of obs\n",
+        size, size, batch, (double)steps * batch / elapsed, elapsed * 1e9 / ((double)steps * batch),
+        (unsigned long long)episodes, env_obs_size(&config) / 1e6);
+
+    env_destroy(env);
+    free(out.obs);
+    free(out.reward);
+    free(out.done);
+    free(actions);
+    free(seeds);
+}
+
+/// a board past BOARD_CELLS_MAX has to be refused by env_create, not
+/// fail later. obs is never written before a reset, one byte will do.
+static void bench_env_oversized(const uint16_t size)
+{
+    const env_config_t config = { .batch = 1, .rows = size, .columns = size, .item_goal = 1 };
+
+    uint8_t obs = 0, done = 0;
+    float reward = 0;
+    const env_buffers_t out = { .obs = &obs, .reward = &reward, .done = &done };
+
+    env_t *env = env_create(&config, &out);
+
+    printf("env %3ux%-3u  %s\n", size, size, env ? "created, should have been refused" : "refused, too big");
+
+    if (env)
+    {
+        env_destroy(env);
+    }
+}
+
+static void bench_env(void)
+{
+    bench_env_size(20, 256, 20000);
+    bench_env_size(255, 16, 20000);
+    bench_env_oversized(65535);
+}
+
+static const bench_t benches[] =
+{
+    { "tick", bench_tick },
+    { "spawn", bench_spawn },
+    { "snapshot", bench_snapshot },
+    { "newgame", bench_new_game },
+    { "raster", bench_raster },
+    { "ai", bench_ai },
+    { "mcts", bench_mcts },
+    { "region", bench_region },
+    { "env", bench_env },
+};
+
+int main(int argc, char *argv[])
+{
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+    {
+        if (argc > 1 && strcmp(argv[1], benches[i].name) != 0)
+        {
+            continue;
+        }
+
+        benches[i].func();
+    }
+
+    return 0;
+}
\ No newline at end of file
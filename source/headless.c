@@ -0,0 +1,59 @@
+#include "snake_core.h"
+
+/// steps ai games back to back with no renderer attached and
+/// reports how many ticks per second the core can push.
+/// usage: snake-headless [games] [seed] [items]
+
+/// stop a game that never ends (ai circling forever).
+#define TICK_LIMIT 100000
+
+int main(int argc, char *argv[])
+{
+    const uint32_t games = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+    const uint64_t seed = snake_parse_seed(argc, argv, 2);
+    const uint16_t items = argc > 3 ? strtoul(argv[3], NULL, 10) : 1;
+
+    game_t *game = snake_init();
+    game->item_goal = items;
+
+    uint64_t total_ticks = 0;
+    uint64_t total_size = 0;
+    uint32_t best_size = 0;
+
+    const double start = snake_get_time();
+
+    for (uint32_t g = 0; g < games; g++)
+    {
+        snake_new_game(game, seed + g);
+        game->state = GameState_PLAY;
+        game->player_type = Player_AI;
+
+        uint32_t ticks = 0;
+        while (!game->game_over && ticks < TICK_LIMIT)
+        {
+            snake_step(game);
+            ticks++;
+        }
+
+        total_ticks += ticks;
+        total_size += game->snake->size;
+        if (game->snake->size > best_size)
+        {
+            best_size = game->snake->size;
+        }
+    }
+
+    const double elapsed = snake_get_time() - start;
+
+    printf("seed:        %llu\n", (unsigned long long)seed);
+    printf("games:       %u\n", games);
+    printf("ticks:       %llu\n", (unsigned long long)total_ticks);
+    printf("avg size:    %.2f\n", games ? (double)total_size / games : 0.0);
+    printf("best size:   %u\n", best_size);
+    printf("elapsed:     %.3fs\n", elapsed);
+    printf("ticks/sec:   %.0f\n", elapsed > 0 ? total_ticks / elapsed : 0.0);
+
+    snake_exit(game);
+
+    return 0;
+}
\ No newline at end of file
@@ -4,7 +4,7 @@ int main(int argc, char *argv[])
 {
     fprintf(stdout, "hello world\n");
 
-    snake_play();
+    snake_play(argc > 1 ? argv[1] : NULL, argc > 2 ? argv[2] : NULL);
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "snake_raster.h"
+#include "snake_capture.h"
+
+/// plays ai games and rasterizes every tick on the cpu, no gpu or
+/// window involved, so the same seed gives the same pixels anywhere.
+/// frames can be captured for review, out is a .y4m video, a printf
+/// pattern for a ppm per frame (frames/%06u.ppm), or else raw rgb24.
+/// usage: snake-render [games] [seed] [size] [scale] [out]
+
+/// stop a game that never ends (ai circling forever).
+#define TICK_LIMIT 100000
+
+/// pixels are the same on every host, so the checksum is too.
+static uint64_t frame_checksum(uint64_t checksum, const framebuffer_t * fb)
+{
+    for (uint32_t y = 0; y < fb->h; y++)
+    {
+        const uint32_t *row = &fb->pixels[(size_t)y * fb->pitch];
+        for (uint32_t x = 0; x < fb->w; x++)
+        {
+            checksum = (checksum ^ row[x]) * 0x100000001B3ULL;
+        }
+    }
+
+    return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+    const uint32_t games = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+    const uint64_t seed = snake_parse_seed(argc, argv, 2);
+    const uint16_t size = argc > 3 ? strtoul(argv[3], NULL, 10) : 20;
+    const uint32_t scale = argc > 4 ? strtoul(argv[4], NULL, 10) : 8;
+    const char *path = argc > 5 ? argv[5] : NULL;
+
+    if (size < 3 || scale == 0)
+    {
+        fprintf(stderr, "size must be at least 3 and scale at least 1\n");
+        return 1;
+    }
+
+    /// the writer thread converts and writes while the next frames render.
+    capture_t capture;
+    if (path && capture_open(&capture, path, capture_format_from_path(path), size * scale, size * scale, 30, 8))
+    {
+        fprintf(stderr, "failed to open %s\n", path);
+        return 1;
+    }
+
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+
+    uint32_t palette[256];
+    raster_palette_default(palette);
+
+    framebuffer_t fb;
+    if (framebuffer_create(&fb, size * scale, size * scale))
+    {
+        fprintf(stderr, "failed to allocate a %ux%u framebuffer\n", size * scale, size * scale);
+        return 1;
+    }
+
+    uint64_t frames = 0;
+    uint64_t checksum = 0xCBF29CE484222325ULL;
+    double raster_time = 0;
+
+    const double start = snake_get_time();
+
+    for (uint32_t g = 0; g < games; g++)
+    {
+        if (snake_new_game(game, seed + g))
+        {
+            fprintf(stderr, "a %ux%u board is too big\n", size, size);
+            return 1;
+        }
+        game->state = GameState_PLAY;
+        game->player_type = Player_AI;
+
+        for (uint32_t ticks = 0; ; ticks++)
+        {
+            const double raster_start = snake_get_time();
+            raster_board(&fb, game->board, palette, scale);
+            raster_time += snake_get_time() - raster_start;
+            frames++;
+
+            if (path)
+            {
+                capture_push_wait(&capture, fb.pixels, fb.w, fb.h, fb.pitch * sizeof(uint32_t));
+            }
+
+            if (game->game_over || ticks == TICK_LIMIT)
+            {
+                break;
+            }
+
+            snake_step(game);
+        }
+
+        checksum = frame_checksum(checksum, &fb);
+    }
+
+    const double elapsed = snake_get_time() - start;
+
+    printf("seed:        %llu\n", (unsigned long long)seed);
+    printf("games:       %u\n", games);
+    printf("frame:       %ux%u\n", fb.w, fb.h);
+    printf("frames:      %llu\n", (unsigned long long)frames);
+    printf("elapsed:     %.3fs\n", elapsed);
+    printf("raster:      %.2f us/frame\n", frames ? raster_time * 1e6 / frames : 0.0);
+    printf("checksum:    %016llx\n", (unsigned long long)checksum);
+
+    if (path)
+    {
+        capture_close(&capture);
+        printf("captured:    %llu frames to %s (%llu failed)\n", (unsigned long long)capture_written(&capture), path,
+            (unsigned long long)atomic_load(&capture.errors));
+    }
+
+    framebuffer_free(&fb);
+    snake_exit(game);
+
+    return 0;
+}
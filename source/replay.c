@@ -0,0 +1,150 @@
+#include "snake_replay.h"
+
+/// records ai games to a replay corpus, or re-simulates a corpus and
+/// checks every game still plays out the way it was recorded.
+/// usage: snake-replay record <file> [games] [seed] [size]
+///        snake-replay verify <file>
+
+/// stop a game that never ends (ai circling forever).
+#define TICK_LIMIT 100000
+
+static int replay_record(const char * path, const uint32_t games, const uint64_t seed, const uint16_t size)
+{
+    replay_writer_t *writer = calloc(1, sizeof(replay_writer_t));
+    assert(writer);
+
+    if (replay_writer_open(writer, path))
+    {
+        fprintf(stderr, "failed to open %s\n", path);
+        free(writer);
+        return 1;
+    }
+
+    game_t *game = snake_init();
+    game->rows = size;
+    game->columns = size;
+    game->recorder = writer;
+
+    uint64_t ticks = 0;
+
+    for (uint32_t g = 0; g < games; g++)
+    {
+        if (snake_new_game(game, seed + g))
+        {
+            fprintf(stderr, "a %ux%u board is too big\n", size, size);
+            replay_writer_close(writer);
+            free(writer);
+            game->recorder = NULL;
+            snake_exit(game);
+            return 1;
+        }
+        game->state = GameState_PLAY;
+        game->player_type = Player_AI;
+
+        uint32_t t = 0;
+        while (!game->game_over && t < TICK_LIMIT)
+        {
+            snake_step(game);
+            t++;
+        }
+
+        ticks += t;
+    }
+
+    replay_writer_end(writer, game);
+    const int err = replay_writer_close(writer);
+    free(writer);
+
+    game->recorder = NULL;
+    snake_exit(game);
+
+    if (err)
+    {
+        fprintf(stderr, "failed to write %s\n", path);
+        return 1;
+    }
+
+    printf("recorded %u games, %llu ticks to %s\n", games, (unsigned long long)ticks, path);
+
+    return 0;
+}
+
+static int replay_verify(const char * path)
+{
+    replay_file_t file;
+    if (replay_file_load(&file, path))
+    {
+        fprintf(stderr, "failed to load %s\n", path);
+        return 1;
+    }
+
+    game_t *game = snake_init();
+
+    uint32_t games = 0;
+    uint32_t mismatches = 0;
+    uint64_t ticks = 0;
+
+    const double start = snake_get_time();
+
+    replay_t replay;
+    int next;
+    while ((next = replay_file_next(&file, &replay)) > 0)
+    {
+        if (!snake_replay_play(game, &replay))
+        {
+            if (mismatches++ < 10)
+            {
+                printf("mismatch: game %u seed %llu\n", games, (unsigned long long)replay.header.seed);
+            }
+        }
+
+        ticks += replay.tick;
+        games++;
+    }
+
+    const double elapsed = snake_get_time() - start;
+
+    if (next < 0)
+    {
+        if (memcmp(replay.header.magic, REPLAY_MAGIC, sizeof(replay.header.magic)) == 0 && replay.header.version != REPLAY_VERSION)
+        {
+            fprintf(stderr, "record %u is replay version %u, this build reads %u\n", games, replay.header.version, REPLAY_VERSION);
+        }
+        else
+        {
+            fprintf(stderr, "record %u is damaged or cut short\n", games);
+        }
+    }
+
+    printf("games:       %u\n", games);
+    printf("mismatches:  %u\n", mismatches);
+    printf("ticks:       %llu\n", (unsigned long long)ticks);
+    printf("elapsed:     %.3fs\n", elapsed);
+    printf("ticks/sec:   %.0f\n", elapsed > 0 ? ticks / elapsed : 0.0);
+
+    snake_exit(game);
+    replay_file_free(&file);
+
+    return mismatches || next < 0 ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2 && strcmp(argv[1], "record") == 0)
+    {
+        const uint32_t games = argc > 3 ? strtoul(argv[3], NULL, 10) : 1000;
+        const uint64_t seed = snake_parse_seed(argc, argv, 4);
+        const uint16_t size = argc > 5 ? strtoul(argv[5], NULL, 10) : 20;
+        return replay_record(argv[2], games, seed, size);
+    }
+
+    if (argc > 2 && strcmp(argv[1], "verify") == 0)
+    {
+        return replay_verify(argv[2]);
+    }
+
+    fprintf(stderr, "usage: %s record <file> [games] [seed] [size]\n", argv[0]);
+    fprintf(stderr, "       %s verify <file>\n", argv[0]);
+
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "snake_shm.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// serves a batched env through shared memory. with no name it forks a
+/// trainer of its own playing random moves, and prints env steps/sec
+/// across the two processes. with a name it serves that ring until the
+/// trainer closes it. a name that is already taken is refused, unless
+/// replace says it was left behind by a run that died.
+/// usage: snake-shm [batch] [slots] [seconds] [size] [name] [replace]
+
+/// what a trainer does with each slot, minus the policy.
+static uint64_t random_trainer(const char * name)
+{
+    shm_ring_t ring;
+
+    /// made before the fork, so it is there to open.
+    if (shm_ring_open(&ring, name))
+    {
+        fprintf(stderr, "failed to open %s\n", name);
+        return 0;
+    }
+
+    rng_t rng;
+    rng_seed(&rng, getpid());
+    const uint32_t batch = ring.header->batch;
+    uint64_t steps = 0;
+
+    for (;;)
+    {
+        const uint32_t slot = shm_ring_acquire(&ring);
+        if (slot == UINT32_MAX)
+        {
+            break;
+        }
+
+        uint8_t *actions = shm_ring_actions(&ring, slot);
+        for (uint32_t g = 0; g < batch; g++)
+        {
+            actions[g] = rng_range(&rng, 4);
+        }
+
+        shm_ring_release(&ring, slot);
+        steps += batch;
+    }
+
+    shm_ring_close(&ring);
+    return steps;
+}
+
+int main(int argc, char *argv[])
+{
+    env_config_t config = {0};
+    config.batch = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+    const uint32_t slots = argc > 2 ? strtoul(argv[2], NULL, 10) : 2;
+    const double seconds = argc > 3 ? strtod(argv[3], NULL) : 3;
+    config.rows = config.columns = argc > 4 ? strtoul(argv[4], NULL, 10) : 20;
+    config.item_goal = 1;
+    config.tick_limit = 1000;
+
+    char name[64];
+    const bool serve = argc > 5;
+    if (serve)
+    {
+        snprintf(name, sizeof(name), "%s", argv[5]);
+    }
+    else
+    {
+        snprintf(name, sizeof(name), "/snake-shm-%d", (int)getpid());
+    }
+
+    if (serve && argc > 6 && strcmp(argv[6], "replace") == 0)
+    {
+        shm_unlink(name);
+    }
+
+    shm_ring_t ring;
+    errno = 0;
+    if (shm_ring_create(&ring, name, &config, slots))
+    {
+        if (errno == EEXIST)
+        {
+            fprintf(stderr, "%s is in use, pass replace if it was left behind\n", name);
+        }
+        else
+        {
+            fprintf(stderr, "failed to create %s\n", name);
+        }
+        return 1;
+    }
+
+    pid_t child = 0;
+    if (!serve)
+    {
+        child = fork();
+        if (child == 0)
+        {
+            random_trainer(name);
+            _exit(0);
+        }
+    }
+    else
+    {
+        printf("serving %s: %u slots of %u games, %ux%u\n", name, slots, config.batch, config.rows, config.columns);
+        fflush(stdout);
+    }
+
+    if (shm_ring_reset(&ring, 1))
+    {
+        fprintf(stderr, "failed to reset %s\n", name);
+        shm_ring_close(&ring);
+        if (child > 0)
+        {
+            waitpid(child, NULL, 0);
+        }
+        return 1;
+    }
+
+    uint64_t handovers = 0;
+    const double start = snake_get_time();
+    double elapsed = 0;
+
+    while (shm_ring_step(&ring))
+    {
+        handovers++;
+
+        elapsed = snake_get_time() - start;
+        if (!serve && elapsed >= seconds)
+        {
+            break;
+        }
+    }
+
+    shm_ring_close(&ring);
+    if (child > 0)
+    {
+        waitpid(child, NULL, 0);
+    }
+
+    printf("games:       %u x %u slots\n", config.batch, slots);
+    printf("handovers:   %llu\n", (unsigned long long)handovers);
+    printf("elapsed:     %.3fs\n", elapsed);
+    printf("steps/sec:   %.0f\n", elapsed > 0 ? handovers * config.batch / elapsed : 0.0);
+    printf("us/handover: %.2f\n", handovers ? elapsed * 1e6 / handovers : 0.0);
+
+    return 0;
+}
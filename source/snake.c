@@ -1,76 +1,147 @@
-#include "snake.h"
+#include "snake_core.h"
+#include "snake_replay.h"
+#include "snake_ai.h"
 
 #define ROWS    20
 #define COLUMNS 20
-#define SCALE   30
 
-#define WIN_W    ROWS * SCALE
-#define WIN_H    COLUMNS * SCALE
+/// item slots a board has at least, more if item_goal asks for more.
+#define ITEM_MAX 321
 
-static void board_free(board_t * board)
+/// game, board and snake structs come from one allocation.
+typedef struct
 {
-    assert(board);
+    game_t game;
+    board_t board;
+    snake_t snake;
+} game_block_t;
 
-    if (board->board && *board->board)
-    {
-        for (uint8_t i = 0; i < board->rows; i++)
-        {
-            free(board->board[i]);
-            board->board[i] = NULL;
-        }
+static inline size_t board_align(const size_t size)
+{
+    return (size + (BOARD_ALIGN - 1)) & ~(size_t)(BOARD_ALIGN - 1);
+}
 
-        free(board->board);
-        board->board = NULL;
-    }
+/// sizes of each part of the board block, in the order they are laid out.
+typedef struct
+{
+    size_t cell_count;
+    size_t cells;
+    size_t items;
+    uint32_t words;
+    size_t bits;
+    size_t free;
+    size_t item_at;
+    size_t total;
+} board_layout_t;
+
+static board_layout_t board_layout(const uint16_t rows, const uint16_t columns, const uint32_t item_max)
+{
+    board_layout_t layout;
+    layout.cell_count = (size_t)(rows + BOARD_PADDING * 2) * (columns + BOARD_PADDING * 2);
+    layout.cells = board_align(layout.cell_count);
+    layout.items = board_align(item_max * sizeof(board_item_t));
+    layout.words = (layout.cell_count + 63) / 64;
+    layout.bits = board_align(layout.words * sizeof(uint64_t));
+    layout.free = board_align(layout.cell_count * sizeof(uint32_t));
+    layout.item_at = board_align(layout.cell_count * sizeof(uint16_t));
+    layout.total = layout.cells + layout.items + layout.bits * BitSet_MAX + layout.free * 2 + layout.item_at;
+    return layout;
+}
+
+static inline void * arena_alloc(arena_t * arena, const size_t size)
+{
+    const size_t aligned = board_align(size);
+    assert(arena->used + aligned <= arena->capacity);
+
+    void *ptr = arena->base + arena->used;
+    arena->used += aligned;
+    return ptr;
+}
+
+/// two region nodes per cell, so rebuilds are rare. ids must stay below
+/// REGION_ROOT.
+static inline uint32_t region_node_max(const size_t cell_count)
+{
+    return cell_count * 2 < REGION_ROOT ? cell_count * 2 : REGION_ROOT - 1;
+}
+
+/// bytes of arena a whole game of this size needs.
+static size_t arena_needed(const uint16_t rows, const uint16_t columns, const uint32_t item_max)
+{
+    const board_layout_t layout = board_layout(rows, columns, item_max);
+    const size_t search = board_align(layout.cell_count * sizeof(uint32_t)) + \
+        board_align(layout.cell_count) * 2 + layout.bits * 2 + \
+        board_align(layout.cell_count * sizeof(uint32_t)) + board_align(layout.cell_count);
+    /// region links for two nodes per cell, plus the cell to node map and
+    /// the split search's marks and queue.
+    const size_t region = board_align(region_node_max(layout.cell_count) * sizeof(uint32_t)) + \
+        board_align(layout.cell_count * sizeof(uint32_t)) * 2 + board_align(layout.cell_count);
+
+    return layout.total + search + region + \
+        board_align((size_t)rows * columns * sizeof(snake_body_t));
+}
 
-    if (board->items)
+/// empties the arena, first swapping in grown (capacity bytes) if the
+/// board grew. only touches the allocator when it does.
+static void arena_reset(arena_t * arena, void * grown, const size_t capacity)
+{
+    if (grown)
     {
-        free(board->items);
-        board->items = NULL;
+        free(arena->base);
+        arena->base = grown;
+        arena->capacity = capacity;
     }
 
+    arena->used = 0;
+}
+
+static void board_clear(board_t * board)
+{
+    assert(board);
+
+    board->data = NULL;
+    board->data_size = 0;
+
+    board->cells = NULL;
+    board->items = NULL;
+    board->item_at = NULL;
     board->rows = 0;
     board->columns = 0;
+    board->stride = 0;
     board->item_count = 0;
+    board->free_count = 0;
 }
 
-static void snake_free(snake_t * snake)
+static void snake_clear(snake_t * snake)
 {
     assert(snake);
 
     snake->size = 0;
     snake->h_pos = 0;
     snake->t_pos = 0;
-
-    if (snake->body)
-    {
-        free(snake->body);
-        snake->body = NULL;
-    }
+    snake->body = NULL;
 }
 
+/// nothing to free, the arena is reused by the next game.
 static void snake_end_game(game_t * game)
 {
-    snake_free(game->snake);
-    board_free(game->board);
+    snake_clear(game->snake);
+    board_clear(game->board);
 }
 
-static game_t * snake_init(void)
+game_t * snake_init(void)
 {
-    game_t *game = calloc(1, sizeof(game_t));
-    assert(game);
-
-    game->board = calloc(1, sizeof(board_t));
-    assert(game->board);
+    game_block_t *block = calloc(1, sizeof(game_block_t));
+    assert(block);
 
-    game->snake = calloc(1, sizeof(snake_t));
-    assert(game->snake);
+    game_t *game = &block->game;
+    game->board = &block->board;
+    game->snake = &block->snake;
 
-    game->renderer = calloc(1, sizeof(renderer_t));
-    assert(game->renderer);
-
-    game->io = calloc(1, sizeof(io_t));
-    assert(game->io);
+    game->rows = ROWS;
+    game->columns = COLUMNS;
+    game->item_goal = 1;
+    game->tick_rate = 10;
 
     return game;
 }
@@ -82,79 +153,129 @@ void snake_exit(game_t * game)
     /// end any current running games.
     snake_end_game(game);
 
-    if (game->io)
-    {
-        free(game->io);
-        game->io = NULL;
-    }
-    if (game->snake)
-    {
-        free(game->snake);
-        game->snake = NULL;
-    }
-    if (game->board)
+    if (game->arena.base)
     {
-        free(game->board);
-        game->board = NULL;
-    }
-    if (game->renderer)
-    {
-        free(game->renderer);
-        game->renderer = NULL;
-    }
-    if (game)
-    {
-        free(game);
-        game = NULL;
+        free(game->arena.base);
+        game->arena.base = NULL;
     }
+
+    /// game is the first member of its block.
+    free(game);
 }
 
-static void board_create(board_t * board, const uint8_t rows, const uint8_t columns)
+static void board_create(board_t * board, arena_t * arena, const uint16_t rows, const uint16_t columns, const uint32_t item_max)
 {
-    assert(board);
+    assert(board); assert(arena);
 
     board->rows = rows;
     board->columns = columns;
-    board->board = calloc(board->rows, sizeof(uint8_t*));
-    assert(board->board);
+    board->stride = columns + BOARD_PADDING * 2;
+
+    board->score = 0;
+    board->item_count = 0;
+    board->item_max = item_max;
 
-    /// allocate the columns, fill empty.
-    for (uint8_t r = 0; r < board->rows; r++)
+    /// nothing on screen belongs to this board yet.
+    board->dirty_count = 0;
+    board->dirty_all = true;
+
+    /// cells (with padding), items, bits, the free list and
+    /// the item index all share one aligned block.
+    const board_layout_t layout = board_layout(rows, columns, board->item_max);
+    board->bits.words = layout.words;
+    board->data_size = layout.total;
+    board->data = arena_alloc(arena, layout.total);
+
+    uint8_t *data = board->data;
+
+    /// the padding is wall, the rest starts empty.
+    memset(data, BoardCellType_WALL, layout.cells);
+    board->cells = data + BOARD_PADDING * board->stride + BOARD_PADDING;
+    data += layout.cells;
+
+    board->items = (board_item_t *)data;
+    memset(board->items, 0, layout.items);
+    data += layout.items;
+
+    /// everything starts as wall, then the playable cells are emptied.
+    for (uint8_t s = 0; s < BitSet_MAX; s++)
+    {
+        board->bits.sets[s] = (uint64_t *)data;
+        memset(board->bits.sets[s], s == BitSet_WALL ? 0xFF : 0, layout.bits);
+        data += layout.bits;
+    }
+
+    board->free_cells = (uint32_t *)data;
+    data += layout.free;
+    board->free_pos = (uint32_t *)data;
+    data += layout.free;
+    board->free_count = 0;
+
+    /// only read for cells holding an item, no need to clear.
+    board->item_at = (uint16_t *)data;
+
+    /// outside the block, so snapshots don't carry it. built by the first query.
+    board->region.node_max = region_node_max(layout.cell_count);
+    board->region.link = arena_alloc(arena, board->region.node_max * sizeof(uint32_t));
+    board->region.node = arena_alloc(arena, layout.cell_count * sizeof(uint32_t));
+    board->region.mark = arena_alloc(arena, layout.cell_count);
+    board->region.queue = arena_alloc(arena, layout.cell_count * sizeof(uint32_t));
+    board->region.mark_clear = false;
+    board->region.node_count = 0;
+    board->region.rebuilds = 0;
+    board->region.splits = 0;
+    board->region.stale = true;
+
+    /// set a basic wall around the board (everything is wall so far),
+    /// by emptying only the inside. levels will have layout of their own.
+    /// done directly rather than through board_set, this runs every new game.
+    uint64_t *walls = board->bits.sets[BitSet_WALL];
+    uint64_t *empty = board->bits.sets[BitSet_EMPTY];
+
+    for (uint16_t r = 1; r + 1 < rows; r++)
     {
-        board->board[r] = calloc(board->columns, sizeof(uint8_t));
-        assert(board->board[r]);
+        memset(&board->cells[(size_t)r * board->stride + 1], BoardCellType_EMPTY, columns - 2);
 
-        for (uint8_t c = 0; c < board->columns; c++)
+        for (uint16_t c = 1; c + 1 < columns; c++)
         {
-            board->board[r][c] = BoardCellType_EMPTY;
+            const uint32_t i = board_bit_index(board, r, c);
+            walls[i >> 6] &= ~(1ULL << (i & 63));
+            empty[i >> 6] |= 1ULL << (i & 63);
+            board->free_pos[i] = board->free_count;
+            board->free_cells[board->free_count++] = i;
         }
     }
+}
 
-    board->item_count = 0;
-    board->item_max = 321;
-    board->items = calloc(board->item_max, sizeof(board_item_t));
-    assert(board->items);
-
-    /// set a basic wall around the board.
-    /// levels will have layout of their own.
-    for (uint8_t i = 0; i < rows; i++)
-    {
-        board->board[i][0] = BoardCellType_WALL;
-        board->board[0][i] = BoardCellType_WALL;
-        board->board[i][rows - 1] = BoardCellType_WALL;
-        board->board[rows - 1][i] = BoardCellType_WALL;
-    }
+static void search_create(search_t * search, const board_t * board, arena_t * arena)
+{
+    assert(search); assert(board); assert(arena);
+
+    /// every padded cell, the searches index by padded cell.
+    const size_t cell_count = (size_t)(board->rows + BOARD_PADDING * 2) * board->stride;
+
+    search->queue = arena_alloc(arena, cell_count * sizeof(uint32_t));
+    search->first = arena_alloc(arena, cell_count);
+    search->from = arena_alloc(arena, cell_count);
+    search->visited = arena_alloc(arena, board->bits.words * sizeof(uint64_t));
+    search->blocked = arena_alloc(arena, board->bits.words * sizeof(uint64_t));
+    search->cycle_order = arena_alloc(arena, cell_count * sizeof(uint32_t));
+    search->cycle_next = arena_alloc(arena, cell_count);
+
+    /// laid out by Player_CYCLE when it first needs it, it touches every cell.
+    search->cycle_length = UINT32_MAX;
+    search->cycle_head = UINT32_MAX;
 }
 
-static void snake_create(board_t * board, snake_t * snake)
+static void snake_create(board_t * board, snake_t * snake, arena_t * arena, rng_t * rng)
 {
-    assert(board); assert(snake);
+    assert(board); assert(snake); assert(arena); assert(rng);
 
     /// create the snake body.
     /// set the size to the size of the board (max size).
-    snake->size_max = board->rows * board->columns;
-    snake->body = calloc(snake->size_max, sizeof(snake_body_t));
-    assert(snake->body);
+    /// only the live part is ever read, so it isn't cleared.
+    snake->size_max = (uint32_t)board->rows * board->columns;
+    snake->body = arena_alloc(arena, snake->size_max * sizeof(snake_body_t));
 
     snake->size = 3;
     snake->h_pos = 0;
@@ -162,7 +283,7 @@ static void snake_create(board_t * board, snake_t * snake)
 
     /// set the head to start in the middle.
     /// the body will be set to the same position as the head.
-    snake->body[0].direction = snake_gen_rand_direction();
+    snake->body[0].direction = snake_gen_rand_direction(rng);
     snake->buffered_direction = snake->body[0].direction;
     snake->body[0].x = board->rows/2;
     snake->body[0].y = board->columns/2;
@@ -194,50 +315,277 @@ static void snake_create(board_t * board, snake_t * snake)
     }
 
     /// head, mid, tail
-    board->board[snake->body[0].x][snake->body[0].y] = BoardCellType_SNAKEHEAD;
-    board->board[snake->body[1].x][snake->body[1].y] = BoardCellType_SNAKEBODY;
-    board->board[snake->body[2].x][snake->body[2].y] = BoardCellType_SNAKEBODY;
+    board_set(board, snake->body[0].x, snake->body[0].y, BoardCellType_SNAKEHEAD);
+    board_set(board, snake->body[1].x, snake->body[1].y, BoardCellType_SNAKEBODY);
+    board_set(board, snake->body[2].x, snake->body[2].y, BoardCellType_SNAKEBODY);
 }
 
-int snake_new_game(game_t * game)
+int snake_new_game(game_t * game, const uint64_t seed)
 {
     assert(game);
 
+    if ((uint64_t)(game->rows + BOARD_PADDING * 2) * (game->columns + BOARD_PADDING * 2) > BOARD_CELLS_MAX)
+    {
+        return -1;
+    }
+
+    const uint32_t item_max = game->item_goal > ITEM_MAX ? game->item_goal : ITEM_MAX;
+    const size_t needed = arena_needed(game->rows, game->columns, item_max);
+    /// allocated while the current game is still there, so it can be kept
+    /// if there isn't the memory.
+    void *grown = NULL;
+    if (needed > game->arena.capacity)
+    {
+        grown = aligned_alloc(BOARD_ALIGN, needed);
+        if (!grown)
+        {
+            return -1;
+        }
+    }
+
+    if (game->recorder)
+    {
+        replay_writer_end(game->recorder, game);
+    }
+
     /// clear game if already playing.
     snake_end_game(game);
 
-    /// how often the board should be updated (frame tick).
-    game->update_freq = 6;
+    game->game_over = false;
+    game->input = KeyType_NONE;
+    rng_seed(&game->rng, seed);
+    game->seed = seed;
 
-    board_create(game->board, ROWS, COLUMNS);
-    snake_create(game->board, game->snake);
+    arena_reset(&game->arena, grown, needed);
+    board_create(game->board, &game->arena, game->rows, game->columns, item_max);
+    snake_create(game->board, game->snake, &game->arena, &game->rng);
+    search_create(&game->search, game->board, &game->arena);
+
+    if (game->recorder)
+    {
+        replay_writer_begin(game->recorder, game);
+    }
 
     return 0;
 }
 
-static inline void snake_run(game_t * game)
+/// everything outside of the board block and the snake body.
+typedef struct
+{
+    uint64_t size;
+    uint16_t rows;
+    uint16_t columns;
+    uint64_t data_size;
+
+    GameState state;
+    bool game_over;
+    KeyType input;
+    rng_t rng;
+    uint64_t seed;
+
+    uint32_t snake_size;
+    uint32_t h_pos;
+    uint32_t t_pos;
+    SnakeDirection buffered_direction;
+
+    uint32_t score;
+    uint32_t item_count;
+    uint32_t free_count;
+} snapshot_header_t;
+
+size_t snake_snapshot_size(const game_t * game)
+{
+    assert(game);
+
+    return sizeof(snapshot_header_t) + game->board->data_size + game->snake->size_max * sizeof(snake_body_t);
+}
+
+size_t snake_snapshot(const game_t * game, void * buffer)
 {
-    snake_poll(game);
-    snake_update(game);
-    snake_render(game);
+    assert(game); assert(buffer);
+
+    const board_t *board = game->board;
+    const snake_t *snake = game->snake;
+
+    snapshot_header_t header = {0};
+    header.rows = board->rows;
+    header.columns = board->columns;
+    header.data_size = board->data_size;
+    header.state = game->state;
+    header.game_over = game->game_over;
+    header.input = game->input;
+    header.rng = game->rng;
+    header.seed = game->seed;
+    header.snake_size = snake->size;
+    header.h_pos = snake->h_pos;
+    header.t_pos = snake->t_pos;
+    header.buffered_direction = snake->buffered_direction;
+    header.score = board->score;
+    header.item_count = board->item_count;
+    header.free_count = board->free_count;
+
+    uint8_t *out = buffer;
+    out += sizeof(snapshot_header_t);
+
+    /// every board pointer is inside data, so one copy covers
+    /// cells, items, bits, the free list and the item index.
+    memcpy(out, board->data, board->data_size);
+    out += board->data_size;
+
+    /// only the live part of the ring buffer, which may wrap.
+    const uint32_t first = snake->size_max - snake->h_pos < snake->size ? snake->size_max - snake->h_pos : snake->size;
+    memcpy(out, &snake->body[snake->h_pos], first * sizeof(snake_body_t));
+    out += first * sizeof(snake_body_t);
+    memcpy(out, snake->body, (snake->size - first) * sizeof(snake_body_t));
+    out += (snake->size - first) * sizeof(snake_body_t);
+
+    header.size = out - (uint8_t *)buffer;
+    memcpy(buffer, &header, sizeof(snapshot_header_t));
+
+    return header.size;
+}
+
+/// false if the snapshot is of a different board size.
+static bool snapshot_header_read(const game_t * game, const void * buffer, snapshot_header_t * header)
+{
+    memcpy(header, buffer, sizeof(snapshot_header_t));
+
+    const board_t *board = game->board;
+    return header->rows == board->rows && header->columns == board->columns && header->data_size == board->data_size;
+}
+
+/// everything but the board block and the body, shared by restore and rewind.
+static void snapshot_header_apply(game_t * game, const snapshot_header_t header)
+{
+    board_t *board = game->board;
+    snake_t *snake = game->snake;
+
+    game->state = header.state;
+    game->game_over = header.game_over;
+    game->input = header.input;
+    game->rng = header.rng;
+    game->seed = header.seed;
+    snake->size = header.snake_size;
+    snake->h_pos = header.h_pos;
+    snake->t_pos = header.t_pos;
+    snake->buffered_direction = header.buffered_direction;
+    board->score = header.score;
+    board->item_count = header.item_count;
+    board->free_count = header.free_count;
+    board->dirty_count = 0;
+    board->dirty_all = true;
+    board->region.stale = true;
+    game->search.cycle_head = UINT32_MAX;
+}
+
+bool snake_restore(game_t * game, const void * buffer)
+{
+    assert(game); assert(buffer);
+
+    board_t *board = game->board;
+    snake_t *snake = game->snake;
+
+    snapshot_header_t header;
+    if (!snapshot_header_read(game, buffer, &header))
+    {
+        return false;
+    }
+
+    snapshot_header_apply(game, header);
+
+    const uint8_t *in = (const uint8_t *)buffer + sizeof(snapshot_header_t);
+
+    memcpy(board->data, in, board->data_size);
+    in += board->data_size;
+
+    const uint32_t first = snake->size_max - snake->h_pos < snake->size ? snake->size_max - snake->h_pos : snake->size;
+    memcpy(&snake->body[snake->h_pos], in, first * sizeof(snake_body_t));
+    in += first * sizeof(snake_body_t);
+    memcpy(snake->body, in, (snake->size - first) * sizeof(snake_body_t));
+
+    board->journal_count = 0;
+    board->journal_full = false;
+
+    return true;
 }
 
-void snake_play()
+bool snake_rewind(game_t * game, const void * buffer)
 {
-    srand(time(NULL));
+    assert(game); assert(buffer);
+
+    board_t *board = game->board;
+    snake_t *snake = game->snake;
+
+    if (!board->journal || board->journal_full || \
+        (size_t)board->journal_count * BOARD_UNDO_BYTES >= board->data_size)
+    {
+        return snake_restore(game, buffer);
+    }
+
+    snapshot_header_t header;
+    if (!snapshot_header_read(game, buffer, &header))
+    {
+        return false;
+    }
+
+    /// every tick changes at least the cell the head moves onto.
+    const uint32_t ticks = board->journal_count;
+
+    /// regions are left to the next query, as a restore does.
+    board->region.stale = true;
+
+    /// newest first, with the journal off so the undo isn't recorded.
+    board_change_t *journal = board->journal;
+    board->journal = NULL;
 
-    game_t *game = snake_init();
-    snake_render_init(game->renderer, WIN_W, WIN_H);
+    for (uint32_t k = board->journal_count; k-- > 0;)
+    {
+        const board_change_t change = journal[k];
+        board_set(board, change.x, change.y, change.type);
+
+        if (change.type == BoardCellType_EMPTY)
+        {
+            /// board_set appended it, swap it back to where it was taken
+            /// from so spawns pick the same cells a restore would.
+            const uint32_t i = board_bit_index(board, change.x, change.y);
+            const uint32_t last = board->free_count - 1;
+            const uint32_t moved = board->free_cells[change.free_pos];
+
+            board->free_cells[last] = moved;
+            board->free_pos[moved] = last;
+            board->free_cells[change.free_pos] = i;
+            board->free_pos[i] = change.free_pos;
+        }
+    }
+
+    board->journal = journal;
+    board->journal_count = 0;
+    assert(board->free_count == header.free_count);
+
+    snapshot_header_apply(game, header);
+
+    const uint8_t *in = (const uint8_t *)buffer + sizeof(snapshot_header_t);
+
+    /// board_set doesn't move items, there are only item_max of them to copy back.
+    const uint8_t *items = in + ((uint8_t *)board->items - (uint8_t *)board->data);
+    memcpy(board->items, items, board->item_count * sizeof(board_item_t));
+    for (uint32_t k = 0; k < board->item_count; k++)
+    {
+        board->item_at[board_bit_index(board, board->items[k].x, board->items[k].y)] = k;
+    }
+    in += board->data_size;
 
-    snake_new_game(game);
-    game->state = GameState_PLAY;
-    game->player_type = Player_AI;
+    /// the ring is only written at the head, which moves a slot each tick,
+    /// and just past the tail. of the live body that is the head and at
+    /// most ticks + 1 slots at the tail end, which the head can wrap into.
+    const snake_body_t *body = (const snake_body_t *)in;
+    const uint32_t tail = ticks + 1 < snake->size ? ticks + 1 : snake->size;
 
-    while (game->state != GameState_QUIT)
+    snake->body[snake->h_pos] = body[0];
+    for (uint32_t k = snake->size - tail; k < snake->size; k++)
     {
-        snake_run(game);
+        snake->body[(snake->h_pos + k) % snake->size_max] = body[k];
     }
 
-    snake_render_exit(game->renderer);
-    snake_exit(game);
+    return true;
 }
\ No newline at end of file
@@ -1,89 +1,78 @@
 #pragma once
 
 #include "includes.h"
+#include "snake_core.h"
+#include "snake_raster.h"
+#include "snake_capture.h"
 
-typedef enum
-{
-    BoardCellType_EMPTY         = '.',
-    BoardCellType_WALL          = '#',
-    BoardCellType_SNAKEBODY     = '-',
-    BoardCellType_SNAKEHEAD     = 'O',
-    BoardCellType_ITEM          = '*',
-} BoardCellType;
-
-typedef enum
+/// board cells queued during a frame and submitted together,
+/// so a frame costs the same number of draw calls at any snake length.
+typedef struct
 {
-    KeyType_NONE,
-    KeyType_UP,
-    KeyType_DOWN,
-    KeyType_LEFT,
-    KeyType_RIGHT,
-} KeyType;
+    uint32_t count;
+    uint32_t capacity;
+    rect_t *rects;
+    /// index into cell_colours for each rect.
+    uint8_t *colours;
 
-typedef enum
-{
-    GameState_PLAY,
-    GameState_PAUSE,
-    GameState_MENU,
-    GameState_QUIT,
-} GameState;
+    #ifdef ALLEGRO
+    /// two triangles per cell, grouped by colour.
+    ALLEGRO_VERTEX *vertices;
+    #elif SDL2
+    /// rects grouped by colour, one fill call per colour.
+    SDL_Rect *sorted;
+    #endif
+} cell_batch_t;
 
-typedef enum
-{
-    SnakeDirection_LEFT,
-    SnakeDirection_DOWN,
-    SnakeDirection_RIGHT,
-    SnakeDirection_UP,
-} SnakeDirection;
-
-typedef struct
-{
-    uint8_t x;
-    uint8_t y;
-    SnakeDirection direction;
-} snake_body_t;
+#define TEXT_CACHE_MAX 32
+#define TEXT_CACHE_LEN 64
 
+/// a string rasterized once and blitted from then on.
 typedef struct
 {
+    char text[TEXT_CACHE_LEN];
+    colour_t colour;
     uint16_t size;
-    uint16_t size_max;
-
-    SnakeDirection buffered_direction;
+    uint32_t w;
+    uint32_t h;
 
-    uint16_t h_pos;
-    uint16_t t_pos;
-    snake_body_t *body;
-} snake_t;
+    /// text_cache_t clock when last drawn, the oldest entry is replaced when full.
+    uint32_t used;
 
-typedef enum
-{
-    ItemType_NONE,
-    ItemType_FOOD,
-    ItemType_POWERUP,
-} ItemType;
+    #ifdef ALLEGRO
+    ALLEGRO_BITMAP *bitmap;
+    #elif SDL2
+    SDL_Texture *texture;
+    #endif
+} text_entry_t;
 
+/// keyed on (text, colour, size). changing text (a score) only
+/// ever replaces its own entry, the rest stay rasterized.
 typedef struct
 {
-    uint8_t x;
-    uint8_t y;
-
-    ItemType type;
-} board_item_t;
+    uint32_t count;
+    uint32_t clock;
+    text_entry_t entries[TEXT_CACHE_MAX];
+} text_cache_t;
 
-typedef struct
+typedef enum
 {
-    uint32_t score;
-
-    uint16_t item_count;
-    uint16_t item_max;
-    board_item_t *items;
-
-    uint8_t rows;
-    uint8_t columns;
-    uint8_t **board;
-} board_t;
-
-typedef struct
+    /// cells drawn as rects into board_image at scale.
+    BoardMode_RECTS,
+    /// one texel per cell in texture, upscaled by the gpu.
+    BoardMode_TEXELS,
+    /// cells rasterized on the cpu into texels at scale, texture drawn 1:1.
+    BoardMode_SOFTWARE,
+    BoardMode_MAX,
+} BoardMode;
+
+/// pixels per cell the board is never shrunk below. a board too big to
+/// fit at this scale is drawn through a camera view of the cells on screen.
+#define RENDER_SCALE_MIN 4
+/// pixels per layout unit for the menu and osd, which don't follow the board.
+#define RENDER_UI_SCALE 30
+
+struct renderer
 {
     bool opengl;
 
@@ -91,74 +80,87 @@ typedef struct
 
     float scale;
 
+    /// the board drawn at scale, kept between frames so only
+    /// the cells the board marks dirty are drawn again.
+    uint32_t board_w;
+    uint32_t board_h;
+    /// set on resize (or lost render targets) to redraw all of it.
+    bool board_redraw;
+    /// something other than a tick changed the screen (input, resize, pan),
+    /// frames are otherwise only drawn after a tick has been played.
+    bool redraw;
+
+    /// cells on screen, the whole board if it fits. follows the head
+    /// unless panned, only these cells are ever drawn.
+    raster_view_t view;
+    bool view_panned;
+
+    BoardMode board_mode;
+    cell_batch_t batch;
+
+    /// optional, every presented frame is read back and queued to it.
+    capture_t *capture;
+
+    /// size the font was loaded at.
+    uint16_t font_size;
+    text_cache_t text;
+
+    /// ARGB8888 colour of each BoardCellType in texture.
+    uint32_t palette[256];
+
+    /// cpu copy of texture, ARGB8888, texels[y * texels_w + x].
+    uint32_t *texels;
+    uint32_t texels_w;
+    uint32_t texels_h;
+
     #ifdef ALLEGRO
     ALLEGRO_DISPLAY *display;
     ALLEGRO_FONT *font;
     ALLEGRO_EVENT_QUEUE *queue;
+    ALLEGRO_BITMAP *board_image;
+    ALLEGRO_BITMAP *texture;
     #elif SDL2
     SDL_Window *window;
     SDL_Renderer *renderer;
     SDL_Texture *texture;
+    SDL_Texture *board_image;
+    /// capture readback, capture->w x capture->h.
+    uint32_t *readback;
     #endif
-} renderer_t;
+};
 
-typedef struct
+struct io
 {
-    KeyType type;
-
     #ifdef ALLEGRO
     ALLEGRO_JOYSTICK *joystick;
+    /// fires game->tick_rate times a second.
+    ALLEGRO_TIMER *timer;
     #elif SDL2
     SDL_Joystick *joystick;
     SDL_GameController *controller;
+    /// SDL_GetTicks time the next game tick is due.
+    uint32_t next_tick;
+    uint32_t tick_ms;
     #endif
-} io_t;
-
-typedef enum
-{
-    Player_NORMAL,
-    Player_AI,
-} Player;
-
-typedef struct
-{
-    /// current render frame.
-    uint8_t frame;
-
-    /// how often to update the game (per frame).
-    uint8_t update_freq;
-
-    /// TODO: cleanly impliment this.
-    Player player_type;
-
-    /// play, pause or quit.
-    GameState state;
-
-    /// the main board.
-    board_t *board;
-
-    /// the snake size, body and direction.
-    snake_t *snake;
-
-    /// window, renderer and (unused) texture.
-    renderer_t *renderer;
-
-    /// joypad / controller structs.
-    io_t *io;
-} game_t;
-
-bool snake_inbounds(board_t * board, const uint8_t x, const uint8_t y);
-SnakeDirection snake_gen_rand_direction(void);
-void board_gen_rand_item_pos(board_t * board, const ItemType type);
+};
 
 int snake_render_init(renderer_t * renderer, const uint32_t w, const uint32_t h);
 void snake_render_exit(renderer_t * renderer);
-
-int snake_new_game(game_t * game);
-void snake_exit(game_t * game);
-
-void snake_poll(game_t * game);
-void snake_update(game_t * game);
+/// the window is now w x h, the board is fitted to it on the next frame.
+void snake_render_resize(renderer_t * renderer, const uint32_t w, const uint32_t h);
+/// moves the view a quarter of its size, dx and dy are -1, 0 or 1.
+/// it stays there until snake_render_follow.
+void snake_render_pan(renderer_t * renderer, const int8_t dx, const int8_t dy);
+/// the view goes back to following the head.
+void snake_render_follow(renderer_t * renderer);
+
+int snake_poll_init(game_t * game);
+void snake_poll_exit(game_t * game);
+/// blocks until an event or tick, handles everything queued,
+/// and returns how many game ticks are now due.
+uint32_t snake_poll(game_t * game);
 void snake_render(game_t * game);
 
-void snake_play();
\ No newline at end of file
+/// record_path (optional) saves a replay of every game played.
+/// capture_path (optional) saves every frame, see capture_format_from_path.
+void snake_play(const char * record_path, const char * capture_path);
\ No newline at end of file
@@ -0,0 +1,431 @@
+#include "snake_ai.h"
+
+typedef enum
+{
+    /// stop at the first item found.
+    SearchGoal_ITEM,
+    /// stop once next to the target cell (the tail, which is itself blocked).
+    SearchGoal_CELL,
+    /// search everything reachable, for the area.
+    SearchGoal_AREA,
+} SearchGoal;
+
+typedef struct
+{
+    /// steps to the goal, -1 if never reached.
+    int32_t distance;
+    /// first move of the path to the goal.
+    SnakeDirection first;
+    /// padded index of the item found (SearchGoal_ITEM).
+    uint32_t cell;
+    /// free cells searched.
+    uint32_t area;
+} search_result_t;
+
+/// padded index offset of a step in each SnakeDirection.
+static inline void search_offsets(const board_t * board, int32_t offset[4])
+{
+    offset[SnakeDirection_LEFT] = -(int32_t)board->stride;
+    offset[SnakeDirection_DOWN] = 1;
+    offset[SnakeDirection_RIGHT] = board->stride;
+    offset[SnakeDirection_UP] = -1;
+}
+
+/// breadth first from start over cells that are not wall or in snake
+/// (the board's snake set, or a planned one in search->blocked).
+/// start itself is never entered again, so it can be a snake cell.
+static search_result_t search_bfs(search_t * search, const board_t * board, const uint64_t * snake,
+    const uint32_t start, const SearchGoal goal, const uint32_t target)
+{
+    search_result_t result = { .distance = -1, .first = SnakeDirection_UP, .cell = 0, .area = 0 };
+
+    int32_t offset[4];
+    search_offsets(board, offset);
+
+    /// blocked cells start out visited so the loop only tests one set.
+    const uint64_t *walls = board->bits.sets[BitSet_WALL];
+    const uint64_t *items = board->bits.sets[BitSet_ITEM];
+    uint64_t *visited = search->visited;
+
+    for (uint32_t w = 0; w < board->bits.words; w++)
+    {
+        visited[w] = walls[w] | snake[w];
+    }
+    visited[start >> 6] |= 1ULL << (start & 63);
+
+    uint32_t *queue = search->queue;
+    uint32_t head = 0, tail = 0;
+    queue[tail++] = start;
+
+    /// queue[level_end] starts the next distance.
+    uint32_t level_end = tail;
+    int32_t depth = 0;
+
+    while (head < tail)
+    {
+        if (head == level_end)
+        {
+            level_end = tail;
+            depth++;
+        }
+
+        const uint32_t cell = queue[head++];
+
+        for (uint8_t d = 0; d < 4; d++)
+        {
+            const uint32_t next = cell + offset[d];
+            const uint8_t first = cell == start ? d : search->first[cell];
+
+            if (goal == SearchGoal_CELL && next == target)
+            {
+                result.distance = depth + 1;
+                result.first = first;
+                result.area = tail - 1;
+                return result;
+            }
+
+            if (bitboard_test(visited, next))
+            {
+                continue;
+            }
+
+            visited[next >> 6] |= 1ULL << (next & 63);
+            search->first[next] = first;
+            search->from[next] = d;
+            queue[tail++] = next;
+
+            if (goal == SearchGoal_ITEM && bitboard_test(items, next))
+            {
+                result.cell = next;
+                result.distance = depth + 1;
+                result.first = first;
+                result.area = tail - 1;
+                return result;
+            }
+        }
+    }
+
+    result.area = tail - 1;
+    return result;
+}
+
+static inline void bit_set(uint64_t * set, const uint32_t i)
+{
+    set[i >> 6] |= 1ULL << (i & 63);
+}
+
+static inline void bit_clear(uint64_t * set, const uint32_t i)
+{
+    set[i >> 6] &= ~(1ULL << (i & 63));
+}
+
+/// plays the path to the item found at food (distance steps away) on a
+/// copy of the snake set, then checks the tail can still be reached from
+/// there, ie, eating it does not box the snake in.
+static bool search_path_safe(search_t * search, const board_t * board, const snake_t * snake,
+    const uint32_t head_cell, const uint32_t food, const uint32_t distance)
+{
+    int32_t offset[4];
+    search_offsets(board, offset);
+
+    uint64_t *blocked = search->blocked;
+    memcpy(blocked, board->bits.sets[BitSet_SNAKE], board->bits.words * sizeof(uint64_t));
+
+    /// walk the path back to the head, path[0] is the first step.
+    uint32_t *path = search->queue;
+    uint32_t cell = food;
+    for (uint32_t i = distance; i-- > 0;)
+    {
+        path[i] = cell;
+        bit_set(blocked, cell);
+        cell -= offset[search->from[cell]];
+    }
+    assert(cell == head_cell); (void)head_cell;
+
+    /// the cells the snake passes through, oldest first, are its body from
+    /// the tail up then the path. it grows by one eating at the end, so
+    /// the first distance - 1 of them are left behind.
+    const uint32_t vacated = distance - 1;
+    uint32_t tail_cell = 0;
+
+    for (uint32_t i = 0; i <= vacated; i++)
+    {
+        if (i < snake->size)
+        {
+            const snake_body_t body = snake->body[(snake->t_pos + snake->size_max - i) % snake->size_max];
+            cell = board_bit_index(board, body.x, body.y);
+        }
+        else
+        {
+            cell = path[i - snake->size];
+        }
+
+        if (i < vacated)
+        {
+            bit_clear(blocked, cell);
+        }
+        else
+        {
+            tail_cell = cell;
+        }
+    }
+
+    return search_bfs(search, board, blocked, food, SearchGoal_CELL, tail_cell).distance > 0;
+}
+
+SnakeDirection snake_ai_path(game_t * game)
+{
+    assert(game);
+
+    const board_t *board = game->board;
+    const snake_t *snake = game->snake;
+    search_t *search = &game->search;
+    const uint64_t *snake_set = board->bits.sets[BitSet_SNAKE];
+
+    const snake_body_t head = snake->body[snake->h_pos];
+    const snake_body_t tail = snake->body[snake->t_pos];
+    const uint32_t head_cell = board_bit_index(board, head.x, head.y);
+    const uint32_t tail_cell = board_bit_index(board, tail.x, tail.y);
+
+    int32_t offset[4];
+    search_offsets(board, offset);
+
+    /// the shortest way to food, as long as the tail can still be
+    /// reached once it has been eaten.
+    const search_result_t food = search_bfs(search, board, snake_set, head_cell, SearchGoal_ITEM, 0);
+    if (food.distance > 0)
+    {
+        if (search_path_safe(search, board, snake, head_cell, food.cell, food.distance))
+        {
+            return food.first;
+        }
+    }
+
+    /// no safe food, chase the tail the long way round to buy time.
+    /// failing that, go where there is the most room.
+    SnakeDirection best_tail = head.direction;
+    SnakeDirection best_area = head.direction;
+    int32_t tail_distance = -1;
+    int32_t most_area = -1;
+
+    for (uint8_t d = 0; d < 4; d++)
+    {
+        const uint32_t next = head_cell + offset[d];
+
+        if (board_blocked(board, next))
+        {
+            continue;
+        }
+
+        const search_result_t follow = search_bfs(search, board, snake_set, next, SearchGoal_CELL, tail_cell);
+        if (follow.distance > tail_distance)
+        {
+            tail_distance = follow.distance;
+            best_tail = d;
+        }
+
+        /// the tail search stops early, only a miss has counted everything.
+        const int32_t area = follow.distance > 0 ? INT32_MAX : (int32_t)follow.area;
+        if (area > most_area)
+        {
+            most_area = area;
+            best_area = d;
+        }
+    }
+
+    return tail_distance > 0 ? best_tail : best_area;
+}
+
+/// shortcuts are only taken while the snake covers less than 1 / CYCLE_CUT_FILL
+/// of the board, past that the cycle itself is about as short as a path gets.
+#define CYCLE_CUT_FILL 2
+/// cells a shortcut leaves between the head and the tail, besides one per item.
+#define CYCLE_SLACK 3
+
+void search_cycle_create(search_t * search, const board_t * board)
+{
+    assert(search); assert(board);
+
+    search->cycle_head = UINT32_MAX;
+    search->cycle_length = 0;
+
+    /// the playable area inside the border board_create lays down.
+    const uint32_t w = board->rows > 2 ? board->rows - 2 : 0;
+    const uint32_t h = board->columns > 2 ? board->columns - 2 : 0;
+
+    /// a grid with an odd number of cells has no hamiltonian cycle.
+    if (w < 2 || h < 2 || (w & 1 && h & 1))
+    {
+        return;
+    }
+
+    /// lanes run along b, one per a, and there has to be an even number
+    /// of them so the last one ends next to where the return row starts.
+    const bool lanes_x = (w & 1) == 0;
+    const uint32_t lanes = lanes_x ? w : h;
+    const uint32_t span = lanes_x ? h : w;
+
+    /// the cells in cycle order, search->queue is free until a search runs.
+    uint32_t *cells = search->queue;
+    uint32_t n = 0;
+
+    for (uint32_t a = 0; a < lanes; a++)
+    {
+        for (uint32_t k = 1; k < span; k++)
+        {
+            const uint32_t b = a & 1 ? span - k : k;
+            cells[n++] = lanes_x ? board_bit_index(board, 1 + a, 1 + b) : board_bit_index(board, 1 + b, 1 + a);
+        }
+    }
+
+    /// back home along b == 0.
+    for (uint32_t a = lanes; a-- > 0;)
+    {
+        cells[n++] = lanes_x ? board_bit_index(board, 1 + a, 1) : board_bit_index(board, 1, 1 + a);
+    }
+
+    int32_t offset[4];
+    search_offsets(board, offset);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const uint32_t cell = cells[i];
+        const int32_t step = (int32_t)cells[(i + 1) % n] - (int32_t)cell;
+
+        assert(!bitboard_test(board->bits.sets[BitSet_WALL], cell));
+        search->cycle_order[cell] = i;
+
+        for (uint8_t d = 0; d < 4; d++)
+        {
+            if (offset[d] == step)
+            {
+                search->cycle_next[cell] = d;
+            }
+        }
+    }
+
+    search->cycle_length = n;
+}
+
+/// steps along the cycle from a to b.
+static inline uint32_t cycle_distance(const search_t * search, const uint32_t a, const uint32_t b)
+{
+    const uint32_t from = search->cycle_order[a];
+    const uint32_t to = search->cycle_order[b];
+
+    return to >= from ? to - from : to + search->cycle_length - from;
+}
+
+/// true if walking the body from the tail only ever moves forwards on the
+/// cycle, ie, everything between the head and the tail going forward is free.
+static bool cycle_in_order(const search_t * search, const board_t * board, const snake_t * snake, const uint32_t tail_cell)
+{
+    uint32_t last = 0;
+
+    for (uint32_t i = 1; i < snake->size; i++)
+    {
+        const snake_body_t body = snake->body[(snake->t_pos + snake->size_max - i) % snake->size_max];
+        const uint32_t distance = cycle_distance(search, tail_cell, board_bit_index(board, body.x, body.y));
+
+        if (distance <= last)
+        {
+            return false;
+        }
+
+        last = distance;
+    }
+
+    return true;
+}
+
+SnakeDirection snake_ai_cycle(game_t * game)
+{
+    assert(game);
+
+    const board_t *board = game->board;
+    const snake_t *snake = game->snake;
+    search_t *search = &game->search;
+
+    if (search->cycle_length == UINT32_MAX)
+    {
+        search_cycle_create(search, board);
+    }
+
+    if (!search->cycle_length)
+    {
+        return snake_ai_path(game);
+    }
+
+    const snake_body_t head = snake->body[snake->h_pos];
+    const snake_body_t tail = snake->body[snake->t_pos];
+    const uint32_t head_cell = board_bit_index(board, head.x, head.y);
+    const uint32_t tail_cell = board_bit_index(board, tail.x, tail.y);
+
+    int32_t offset[4];
+    search_offsets(board, offset);
+
+    const SnakeDirection next = search->cycle_next[head_cell];
+    const bool next_free = !board_blocked(board, head_cell + offset[next]);
+
+    /// moves made here keep the body in order, so it only needs checking
+    /// after a new game, a restore or someone else moving the snake.
+    if (head_cell != search->cycle_head && !cycle_in_order(search, board, snake, tail_cell))
+    {
+        /// the start isn't laid along the cycle, following it lines up
+        /// the whole body within size moves.
+        search->cycle_head = UINT32_MAX;
+        return next_free ? next : snake_ai_path(game);
+    }
+
+    /// in order, the cells ahead up to the tail are free, so the next one is
+    /// too unless the board is full. nothing is left to do but try.
+    if (!next_free)
+    {
+        search->cycle_head = UINT32_MAX;
+        return snake_ai_path(game);
+    }
+
+    /// how far along the cycle a single move may jump: never past the
+    /// nearest item, and never so close to the tail that growing could
+    /// run the head into it before it moves on.
+    const uint32_t tail_distance = cycle_distance(search, head_cell, tail_cell);
+    uint32_t item_distance = search->cycle_length;
+
+    for (uint32_t i = 0; i < board->item_count; i++)
+    {
+        const uint32_t distance = cycle_distance(search, head_cell, board_bit_index(board, board->items[i].x, board->items[i].y));
+        item_distance = distance < item_distance ? distance : item_distance;
+    }
+
+    const uint32_t keep = CYCLE_SLACK + board->item_count;
+    uint32_t cut = 0;
+
+    if (snake->size * CYCLE_CUT_FILL < search->cycle_length && tail_distance > keep)
+    {
+        cut = tail_distance - keep;
+        cut = item_distance < cut ? item_distance : cut;
+    }
+
+    SnakeDirection best = next;
+    uint32_t best_distance = 1;
+
+    for (uint8_t d = 0; d < 4; d++)
+    {
+        const uint32_t cell = head_cell + offset[d];
+
+        if (board_blocked(board, cell))
+        {
+            continue;
+        }
+
+        const uint32_t distance = cycle_distance(search, head_cell, cell);
+        if (distance > best_distance && distance <= cut)
+        {
+            best_distance = distance;
+            best = d;
+        }
+    }
+
+    search->cycle_head = head_cell + offset[best];
+    return best;
+}
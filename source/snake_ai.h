@@ -0,0 +1,21 @@
+#pragma once
+
+#include "snake_core.h"
+
+/// players that search the board rather than steer at the item.
+/// all scratch comes from game->search, so deciding never allocates.
+
+/// shortest path to the nearest item, taken only if the tail can
+/// still be reached after the first step. otherwise it follows the
+/// tail the long way round, or failing that heads for the most room.
+SnakeDirection snake_ai_path(game_t * game);
+
+/// lays out search->cycle_* for the board's playable area, called by
+/// snake_ai_cycle the first time a game needs it. the cycle runs lanes
+/// back and forth across the board and returns along its first row or column.
+void search_cycle_create(search_t * search, const board_t * board);
+
+/// follows the cycle, which alone fills the board, cutting across it
+/// towards the item while the snake is short and the cut cannot pass the
+/// tail. falls back to snake_ai_path on boards with no cycle.
+SnakeDirection snake_ai_cycle(game_t * game);
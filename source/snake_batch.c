@@ -0,0 +1,253 @@
+#include "snake_batch.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/// a worker's remaining games, begin in the low half and end in the high half.
+/// the owner takes from the front, thieves take from the back, both with a CAS.
+#define RANGE_PACK(begin, end) (((uint64_t)(end) << 32) | (uint32_t)(begin))
+#define RANGE_BEGIN(range) ((uint32_t)(range))
+#define RANGE_END(range) ((uint32_t)((range) >> 32))
+
+typedef struct batch batch_t;
+
+typedef struct
+{
+    /// own cache line so workers never false share.
+    _Alignas(64) _Atomic uint64_t range;
+
+    uint32_t id;
+    uint64_t ticks;
+    uint64_t steals;
+
+    game_t *game;
+    batch_t *batch;
+    pthread_t thread;
+} batch_worker_t;
+
+struct batch
+{
+    const batch_config_t *config;
+    batch_game_t *games;
+
+    uint32_t worker_count;
+    batch_worker_t *workers;
+};
+
+static bool batch_pop(batch_worker_t * worker, uint32_t * index)
+{
+    uint64_t range = atomic_load_explicit(&worker->range, memory_order_acquire);
+
+    for (;;)
+    {
+        const uint32_t begin = RANGE_BEGIN(range);
+        const uint32_t end = RANGE_END(range);
+
+        if (begin >= end)
+        {
+            return false;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&worker->range, &range, RANGE_PACK(begin + 1, end),
+            memory_order_acq_rel, memory_order_acquire))
+        {
+            *index = begin;
+            return true;
+        }
+    }
+}
+
+/// moves the back half of victim's range into thief, only called by the thief
+/// once its own range is empty.
+static bool batch_steal(batch_worker_t * thief, batch_worker_t * victim)
+{
+    uint64_t range = atomic_load_explicit(&victim->range, memory_order_acquire);
+
+    for (;;)
+    {
+        const uint32_t begin = RANGE_BEGIN(range);
+        const uint32_t end = RANGE_END(range);
+
+        if (begin >= end)
+        {
+            return false;
+        }
+
+        const uint32_t split = end - (end - begin + 1) / 2;
+
+        if (atomic_compare_exchange_weak_explicit(&victim->range, &range, RANGE_PACK(begin, split),
+            memory_order_acq_rel, memory_order_acquire))
+        {
+            atomic_store_explicit(&thief->range, RANGE_PACK(split, end), memory_order_release);
+            thief->steals++;
+            return true;
+        }
+    }
+}
+
+static void batch_play(batch_worker_t * worker, const uint32_t index)
+{
+    const batch_config_t *config = worker->batch->config;
+    game_t *game = worker->game;
+
+    /// a board too big to make is left as a game of all zeros.
+    if (snake_new_game(game, config->seed + index))
+    {
+        return;
+    }
+    game->state = GameState_PLAY;
+    game->player_type = config->player;
+
+    const double start = snake_get_time();
+
+    uint32_t ticks = 0;
+    while (!game->game_over && ticks < config->tick_limit)
+    {
+        snake_step(game);
+        ticks++;
+    }
+
+    const double elapsed = snake_get_time() - start;
+
+    batch_game_t *result = &worker->batch->games[index];
+    result->ticks = ticks;
+    result->score = game->board->score;
+    result->size = game->snake->size;
+    result->ticks_per_sec = elapsed > 0 ? ticks / elapsed : 0;
+
+    worker->ticks += ticks;
+}
+
+static void * batch_thread(void * arg)
+{
+    batch_worker_t *worker = arg;
+    batch_t *batch = worker->batch;
+
+    for (;;)
+    {
+        uint32_t index;
+        while (batch_pop(worker, &index))
+        {
+            batch_play(worker, index);
+        }
+
+        /// nothing left locally, look for a victim.
+        /// no new work is ever created, so a full lap with nothing
+        /// to steal means every game has been handed out.
+        bool stolen = false;
+        for (uint32_t i = 1; i < batch->worker_count && !stolen; i++)
+        {
+            stolen = batch_steal(worker, &batch->workers[(worker->id + i) % batch->worker_count]);
+        }
+
+        if (!stolen)
+        {
+            return NULL;
+        }
+    }
+}
+
+int snake_batch_run(const batch_config_t * config, batch_result_t * result)
+{
+    assert(config); assert(result);
+
+    memset(result, 0, sizeof(batch_result_t));
+
+    batch_t batch = {0};
+    batch.config = config;
+    batch.worker_count = config->threads ? config->threads : snake_cpu_count();
+
+    batch.games = calloc(config->games ? config->games : 1, sizeof(batch_game_t));
+    assert(batch.games);
+
+    batch.workers = aligned_alloc(_Alignof(batch_worker_t), batch.worker_count * sizeof(batch_worker_t));
+    assert(batch.workers);
+    memset(batch.workers, 0, batch.worker_count * sizeof(batch_worker_t));
+
+    /// start with an even split, stealing evens out the rest.
+    for (uint32_t i = 0; i < batch.worker_count; i++)
+    {
+        batch_worker_t *worker = &batch.workers[i];
+        const uint32_t begin = (uint64_t)config->games * i / batch.worker_count;
+        const uint32_t end = (uint64_t)config->games * (i + 1) / batch.worker_count;
+
+        atomic_init(&worker->range, RANGE_PACK(begin, end));
+        worker->id = i;
+        worker->batch = &batch;
+        worker->game = snake_init();
+        worker->game->rows = config->rows;
+        worker->game->columns = config->columns;
+        worker->game->item_goal = config->item_goal;
+    }
+
+    const double start = snake_get_time();
+
+    /// worker 0 runs on the calling thread.
+    uint32_t started = 1;
+    while (started < batch.worker_count && \
+        pthread_create(&batch.workers[started].thread, NULL, batch_thread, &batch.workers[started]) == 0)
+    {
+        started++;
+    }
+
+    /// a thread that couldn't start fails the run. every range is emptied,
+    /// so the threads already going stop after the game they are on.
+    const bool failed = started != batch.worker_count;
+    if (failed)
+    {
+        for (uint32_t i = 0; i < batch.worker_count; i++)
+        {
+            atomic_store_explicit(&batch.workers[i].range, RANGE_PACK(0, 0), memory_order_release);
+        }
+    }
+    else
+    {
+        batch_thread(&batch.workers[0]);
+    }
+
+    for (uint32_t i = 1; i < started; i++)
+    {
+        pthread_join(batch.workers[i].thread, NULL);
+    }
+
+    if (failed)
+    {
+        for (uint32_t i = 0; i < batch.worker_count; i++)
+        {
+            snake_exit(batch.workers[i].game);
+        }
+
+        free(batch.workers);
+        free(batch.games);
+        return -1;
+    }
+
+    result->elapsed = snake_get_time() - start;
+    result->games = batch.games;
+    result->game_count = config->games;
+    result->threads = batch.worker_count;
+
+    for (uint32_t i = 0; i < batch.worker_count; i++)
+    {
+        result->ticks += batch.workers[i].ticks;
+        result->steals += batch.workers[i].steals;
+        snake_exit(batch.workers[i].game);
+    }
+
+    free(batch.workers);
+
+    return 0;
+}
+
+void snake_batch_free(batch_result_t * result)
+{
+    assert(result);
+
+    if (result->games)
+    {
+        free(result->games);
+        result->games = NULL;
+    }
+
+    result->game_count = 0;
+}
\ No newline at end of file
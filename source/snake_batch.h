@@ -0,0 +1,48 @@
+#pragma once
+
+#include "snake_core.h"
+
+/// runs many independent ai games across threads.
+/// each worker owns a range of game indices and steals half of
+/// another worker's range once its own runs dry, so long games
+/// don't leave the other cores idle.
+
+typedef struct
+{
+    uint32_t games;
+    /// 0 uses every online cpu.
+    uint32_t threads;
+    /// stop a game that never ends (ai circling forever).
+    uint32_t tick_limit;
+    uint16_t item_goal;
+    /// game i is seeded with seed + i, so results don't depend on threads.
+    uint64_t seed;
+    uint16_t rows;
+    uint16_t columns;
+    /// Player_AI, Player_ROOM, Player_PATH or Player_CYCLE.
+    Player player;
+} batch_config_t;
+
+typedef struct
+{
+    uint32_t ticks;
+    uint32_t score;
+    uint32_t size;
+    float ticks_per_sec;
+} batch_game_t;
+
+typedef struct
+{
+    /// one entry per game, in game order.
+    batch_game_t *games;
+    uint32_t game_count;
+
+    uint32_t threads;
+    uint64_t ticks;
+    uint64_t steals;
+    double elapsed;
+} batch_result_t;
+
+/// -1, with nothing in result, if a worker thread can't be started.
+int snake_batch_run(const batch_config_t * config, batch_result_t * result);
+void snake_batch_free(batch_result_t * result);
\ No newline at end of file
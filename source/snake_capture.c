@@ -0,0 +1,343 @@
+#include "snake_capture.h"
+
+#include <errno.h>
+#include <sched.h>
+
+CaptureFormat capture_format_from_path(const char * path)
+{
+    assert(path);
+
+    if (strchr(path, '%'))
+    {
+        return CaptureFormat_PPM;
+    }
+
+    const size_t len = strlen(path);
+    if (len >= 4 && strcmp(path + len - 4, ".y4m") == 0)
+    {
+        return CaptureFormat_Y4M;
+    }
+
+    return CaptureFormat_RAW;
+}
+
+/// a PPM path is used as a printf format, so it may hold exactly one %u,
+/// optionally padded (%06u), and no other conversion.
+static bool capture_pattern_valid(const char * path)
+{
+    uint32_t conversions = 0;
+
+    for (const char *p = strchr(path, '%'); p; p = strchr(p, '%'))
+    {
+        p++;
+        if (*p == '0')
+        {
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+        if (*p != 'u')
+        {
+            return false;
+        }
+
+        conversions++;
+    }
+
+    return conversions == 1;
+}
+
+static void pixel_rgb(const uint32_t p, int * r, int * g, int * b)
+{
+    *r = (p >> 16) & 0xFF;
+    *g = (p >> 8) & 0xFF;
+    *b = p & 0xFF;
+}
+
+/// packed rgb24, one frame into scratch, returns the byte count.
+static size_t convert_rgb(const capture_t * capture, const uint32_t * frame)
+{
+    uint8_t *out = capture->scratch;
+    const size_t count = (size_t)capture->w * capture->h;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        *out++ = (frame[i] >> 16) & 0xFF;
+        *out++ = (frame[i] >> 8) & 0xFF;
+        *out++ = frame[i] & 0xFF;
+    }
+
+    return out - capture->scratch;
+}
+
+/// bt.601 limited range, chroma from the average of each 2x2 block.
+static size_t convert_yuv420(const capture_t * capture, const uint32_t * frame)
+{
+    const uint32_t w = capture->w;
+    const uint32_t h = capture->h;
+    const uint32_t cw = (w + 1) / 2;
+    const uint32_t ch = (h + 1) / 2;
+
+    uint8_t *y_plane = capture->scratch;
+    uint8_t *u_plane = y_plane + (size_t)w * h;
+    uint8_t *v_plane = u_plane + (size_t)cw * ch;
+
+    for (uint32_t y = 0; y < h; y++)
+    {
+        for (uint32_t x = 0; x < w; x++)
+        {
+            int r, g, b;
+            pixel_rgb(frame[(size_t)y * w + x], &r, &g, &b);
+            y_plane[(size_t)y * w + x] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        }
+    }
+
+    for (uint32_t y = 0; y < ch; y++)
+    {
+        for (uint32_t x = 0; x < cw; x++)
+        {
+            /// odd sizes repeat the last row / column.
+            const uint32_t x0 = x * 2, x1 = x * 2 + 1 < w ? x * 2 + 1 : x * 2;
+            const uint32_t y0 = y * 2, y1 = y * 2 + 1 < h ? y * 2 + 1 : y * 2;
+
+            int r = 0, g = 0, b = 0;
+            const uint32_t quad[4] =
+            {
+                frame[(size_t)y0 * w + x0], frame[(size_t)y0 * w + x1],
+                frame[(size_t)y1 * w + x0], frame[(size_t)y1 * w + x1],
+            };
+
+            for (uint8_t i = 0; i < 4; i++)
+            {
+                int pr, pg, pb;
+                pixel_rgb(quad[i], &pr, &pg, &pb);
+                r += pr; g += pg; b += pb;
+            }
+
+            r /= 4; g /= 4; b /= 4;
+            u_plane[(size_t)y * cw + x] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+            v_plane[(size_t)y * cw + x] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+        }
+    }
+
+    return (size_t)w * h + (size_t)cw * ch * 2;
+}
+
+static bool capture_write_frame(capture_t * capture, const uint32_t * frame, const uint64_t number)
+{
+    switch (capture->format)
+    {
+        case CaptureFormat_RAW:
+        {
+            const size_t bytes = convert_rgb(capture, frame);
+            return fwrite(capture->scratch, 1, bytes, capture->file) == bytes;
+        }
+
+        case CaptureFormat_Y4M:
+        {
+            const size_t bytes = convert_yuv420(capture, frame);
+            return fputs("FRAME\n", capture->file) >= 0 && \
+                fwrite(capture->scratch, 1, bytes, capture->file) == bytes;
+        }
+
+        case CaptureFormat_PPM:
+        {
+            char path[sizeof(capture->path) + 32];
+            snprintf(path, sizeof(path), capture->path, (unsigned)number);
+
+            FILE *file = fopen(path, "wb");
+            if (!file)
+            {
+                return false;
+            }
+
+            const size_t bytes = convert_rgb(capture, frame);
+            fprintf(file, "P6\n%u %u\n255\n", capture->w, capture->h);
+            const bool ok = fwrite(capture->scratch, 1, bytes, file) == bytes;
+            return fclose(file) == 0 && ok;
+        }
+    }
+
+    return false;
+}
+
+static void * capture_thread(void * arg)
+{
+    capture_t *capture = arg;
+    const size_t frame_pixels = (size_t)capture->w * capture->h;
+
+    for (;;)
+    {
+        while (sem_wait(&capture->ready) != 0 && errno == EINTR);
+
+        const uint64_t tail = atomic_load_explicit(&capture->tail, memory_order_relaxed);
+        const uint64_t head = atomic_load_explicit(&capture->head, memory_order_acquire);
+
+        if (tail == head)
+        {
+            /// the close post, everything before it has been written.
+            if (atomic_load_explicit(&capture->closing, memory_order_acquire))
+            {
+                return NULL;
+            }
+            continue;
+        }
+
+        const uint32_t *frame = &capture->slots[(tail % capture->slot_count) * frame_pixels];
+        if (!capture_write_frame(capture, frame, tail))
+        {
+            atomic_fetch_add_explicit(&capture->errors, 1, memory_order_relaxed);
+        }
+
+        /// hands the slot back to the game.
+        atomic_store_explicit(&capture->tail, tail + 1, memory_order_release);
+    }
+}
+
+int capture_open(capture_t * capture, const char * path, const CaptureFormat format,
+    const uint32_t w, const uint32_t h, const uint32_t fps, const uint32_t slot_count)
+{
+    assert(capture); assert(path); assert(w); assert(h); assert(slot_count);
+
+    memset(capture, 0, sizeof(capture_t));
+
+    if (strlen(path) >= sizeof(capture->path))
+    {
+        return -1;
+    }
+
+    if (format == CaptureFormat_PPM && !capture_pattern_valid(path))
+    {
+        return -1;
+    }
+
+    snprintf(capture->path, sizeof(capture->path), "%s", path);
+    capture->format = format;
+    capture->w = w;
+    capture->h = h;
+    capture->fps = fps ? fps : 30;
+    capture->slot_count = slot_count;
+
+    if (format != CaptureFormat_PPM)
+    {
+        capture->file = fopen(path, "wb");
+        if (!capture->file)
+        {
+            return -1;
+        }
+
+        /// the writer only ever writes whole frames, let stdio batch them.
+        setvbuf(capture->file, NULL, _IOFBF, 1 << 20);
+    }
+
+    if (format == CaptureFormat_Y4M)
+    {
+        fprintf(capture->file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", w, h, capture->fps);
+    }
+
+    capture->slots = malloc((size_t)w * h * sizeof(uint32_t) * slot_count);
+    capture->scratch = malloc((size_t)w * h * 3);
+    assert(capture->slots); assert(capture->scratch);
+
+    atomic_init(&capture->head, 0);
+    atomic_init(&capture->tail, 0);
+    atomic_init(&capture->errors, 0);
+    atomic_init(&capture->closing, false);
+    sem_init(&capture->ready, 0, 0);
+
+    if (pthread_create(&capture->thread, NULL, capture_thread, capture) != 0)
+    {
+        sem_destroy(&capture->ready);
+        if (capture->file)
+        {
+            fclose(capture->file);
+            capture->file = NULL;
+        }
+        free(capture->slots);
+        free(capture->scratch);
+        capture->slots = NULL;
+        capture->scratch = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void capture_copy(capture_t * capture, uint32_t * slot, const void * pixels, const uint32_t w, const uint32_t h, const ptrdiff_t pitch)
+{
+    const uint32_t copy_w = w < capture->w ? w : capture->w;
+    const uint32_t copy_h = h < capture->h ? h : capture->h;
+
+    for (uint32_t y = 0; y < copy_h; y++)
+    {
+        uint32_t *dst = &slot[(size_t)y * capture->w];
+        memcpy(dst, (const uint8_t *)pixels + y * pitch, copy_w * sizeof(uint32_t));
+        memset(dst + copy_w, 0, (capture->w - copy_w) * sizeof(uint32_t));
+    }
+
+    memset(&slot[(size_t)copy_h * capture->w], 0, (size_t)(capture->h - copy_h) * capture->w * sizeof(uint32_t));
+}
+
+bool capture_push(capture_t * capture, const void * pixels, const uint32_t w, const uint32_t h, const ptrdiff_t pitch)
+{
+    assert(capture); assert(pixels);
+
+    /// only the game moves head, so relaxed is enough for our own counter.
+    const uint64_t head = atomic_load_explicit(&capture->head, memory_order_relaxed);
+    const uint64_t tail = atomic_load_explicit(&capture->tail, memory_order_acquire);
+
+    if (head - tail >= capture->slot_count)
+    {
+        capture->dropped++;
+        return false;
+    }
+
+    uint32_t *slot = &capture->slots[(head % capture->slot_count) * (size_t)capture->w * capture->h];
+    capture_copy(capture, slot, pixels, w, h, pitch);
+
+    atomic_store_explicit(&capture->head, head + 1, memory_order_release);
+    sem_post(&capture->ready);
+
+    return true;
+}
+
+void capture_push_wait(capture_t * capture, const void * pixels, const uint32_t w, const uint32_t h, const ptrdiff_t pitch)
+{
+    assert(capture); assert(pixels);
+
+    const uint64_t head = atomic_load_explicit(&capture->head, memory_order_relaxed);
+    while (head - atomic_load_explicit(&capture->tail, memory_order_acquire) >= capture->slot_count)
+    {
+        sched_yield();
+    }
+
+    capture_push(capture, pixels, w, h, pitch);
+}
+
+void capture_close(capture_t * capture)
+{
+    assert(capture);
+
+    if (!capture->slots)
+    {
+        return;
+    }
+
+    atomic_store_explicit(&capture->closing, true, memory_order_release);
+    sem_post(&capture->ready);
+    pthread_join(capture->thread, NULL);
+    sem_destroy(&capture->ready);
+
+    if (capture->file)
+    {
+        fclose(capture->file);
+        capture->file = NULL;
+    }
+
+    free(capture->slots);
+    free(capture->scratch);
+    capture->slots = NULL;
+    capture->scratch = NULL;
+}
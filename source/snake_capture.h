@@ -0,0 +1,94 @@
+#pragma once
+
+#include "snake_core.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+/// records rendered frames to disk without the caller ever touching the disk.
+/// frames are copied into a fixed ring of slots (single producer, single
+/// consumer, lock-free) and a writer thread converts and writes them out.
+/// if the writer falls behind and the ring is full the frame is dropped
+/// and counted, the caller never waits.
+
+typedef enum
+{
+    /// packed rgb24, no header, every frame back to back.
+    CaptureFormat_RAW,
+    /// yuv4mpeg2, 4:2:0, plays in mpv / ffmpeg as is.
+    CaptureFormat_Y4M,
+    /// one binary ppm per frame, path is a printf pattern with a single %u
+/// (or %06u) for the frame number. capture_open rejects anything else.
+    CaptureFormat_PPM,
+} CaptureFormat;
+
+typedef struct
+{
+    CaptureFormat format;
+    char path[256];
+    FILE *file;
+
+    /// every frame is w x h, ARGB8888 as the renderers use.
+    uint32_t w;
+    uint32_t h;
+    uint32_t fps;
+
+    /// slot_count frames of w * h pixels.
+    uint32_t *slots;
+    uint32_t slot_count;
+
+    /// frames pushed (head) and written (tail), slot = n % slot_count.
+    /// own cache lines, one is only written by the game, the other by the writer.
+    _Alignas(64) _Atomic uint64_t head;
+    _Alignas(64) _Atomic uint64_t tail;
+
+    _Alignas(64) uint64_t dropped;
+    /// frames the writer failed to write (disk full, bad path).
+    _Atomic uint64_t errors;
+
+    /// posted once per pushed frame (and on close), the writer sleeps on it.
+    sem_t ready;
+    _Atomic bool closing;
+    pthread_t thread;
+
+    /// writer side scratch for converting a frame.
+    uint8_t *scratch;
+} capture_t;
+
+/// picks the format from path: a '%' means PPM, ".y4m" means Y4M, else RAW.
+CaptureFormat capture_format_from_path(const char * path);
+
+int capture_open(capture_t * capture, const char * path, const CaptureFormat format,
+    const uint32_t w, const uint32_t h, const uint32_t fps, const uint32_t slot_count);
+
+/// copies a frame (pitch in bytes, may be negative for bottom up images)
+/// into the ring. anything past w x h is ignored and anything missing is black.
+/// returns false, and counts a drop, if the writer has fallen behind.
+bool capture_push(capture_t * capture, const void * pixels, const uint32_t w, const uint32_t h, const ptrdiff_t pitch);
+
+/// true if a push right now would be kept, so callers with a costly
+/// readback can skip it. a false counts the frame as dropped.
+static inline bool capture_reserve(capture_t * capture)
+{
+    const uint64_t head = atomic_load_explicit(&capture->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&capture->tail, memory_order_acquire) >= capture->slot_count)
+    {
+        capture->dropped++;
+        return false;
+    }
+
+    return true;
+}
+
+/// as capture_push, but waits for a free slot instead of dropping.
+/// for offline tools where every frame matters more than pacing.
+void capture_push_wait(capture_t * capture, const void * pixels, const uint32_t w, const uint32_t h, const ptrdiff_t pitch);
+
+/// writes out everything still queued, then stops the writer.
+void capture_close(capture_t * capture);
+
+static inline uint64_t capture_written(capture_t * capture)
+{
+    return atomic_load_explicit(&capture->tail, memory_order_acquire);
+}
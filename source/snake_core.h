@@ -0,0 +1,518 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include "snake_rng.h"
+
+/// the game logic (board, snake, update) lives here and has no
+/// dependency on any renderer, so it can be built headless.
+
+typedef enum
+{
+    BoardCellType_EMPTY         = '.',
+    BoardCellType_WALL          = '#',
+    BoardCellType_SNAKEBODY     = '-',
+    BoardCellType_SNAKEHEAD     = 'O',
+    BoardCellType_ITEM          = '*',
+} BoardCellType;
+
+typedef enum
+{
+    KeyType_NONE,
+    KeyType_UP,
+    KeyType_DOWN,
+    KeyType_LEFT,
+    KeyType_RIGHT,
+} KeyType;
+
+typedef enum
+{
+    GameState_PLAY,
+    GameState_PAUSE,
+    GameState_MENU,
+    GameState_QUIT,
+} GameState;
+
+typedef enum
+{
+    SnakeDirection_LEFT,
+    SnakeDirection_DOWN,
+    SnakeDirection_RIGHT,
+    SnakeDirection_UP,
+} SnakeDirection;
+
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    SnakeDirection direction;
+} snake_body_t;
+
+typedef struct
+{
+    uint32_t size;
+    uint32_t size_max;
+
+    SnakeDirection buffered_direction;
+
+    uint32_t h_pos;
+    uint32_t t_pos;
+    snake_body_t *body;
+} snake_t;
+
+typedef enum
+{
+    ItemType_NONE,
+    ItemType_FOOD,
+    ItemType_POWERUP,
+} ItemType;
+
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+
+    ItemType type;
+} board_item_t;
+
+typedef enum
+{
+    BitSet_EMPTY,
+    BitSet_WALL,
+    /// body and head.
+    BitSet_SNAKE,
+    BitSet_ITEM,
+    BitSet_MAX,
+} BitSet;
+
+/// one bit per cell (padding included), bit = (x + BOARD_PADDING) * stride + (y + BOARD_PADDING).
+/// every cell is in exactly one set, the padding and any bits past
+/// the end of the board are wall.
+typedef struct
+{
+    uint64_t *sets[BitSet_MAX];
+
+    /// number of uint64_t in each set.
+    uint32_t words;
+} bitboard_t;
+
+/// union-find over the free cells, kept up to date by board_set.
+/// a freed cell merges with its neighbours straight away. a filled cell
+/// can split its region, which union-find can't undo: unless its free
+/// neighbours are joined right around it, a search from each of them finds
+/// which pieces are cut off and gives them nodes of their own. every freed
+/// cell takes a new node (an old one may still be a parent of others), so
+/// once they run out the whole thing is rebuilt by the next query.
+typedef struct
+{
+    /// parent of every node, or REGION_ROOT | size for a root.
+    uint32_t *link;
+    /// node of each free padded cell.
+    uint32_t *node;
+    uint32_t node_count;
+    uint32_t node_max;
+
+    /// split search scratch, per padded cell. mark is 1 + the search that
+    /// reached the cell, and each split clears the marks it set.
+    uint8_t *mark;
+    uint32_t *queue;
+    /// the arena isn't cleared, the first split clears mark.
+    bool mark_clear;
+
+    /// nothing is kept up to date until a query rebuilds it.
+    bool stale;
+    uint64_t rebuilds;
+    uint64_t splits;
+} region_t;
+
+/// node ids stay below it, a region's size fits below it.
+#define REGION_ROOT 0x80000000u
+
+/// cells a frame can change before the renderer gives up and redraws
+/// everything, a tick touches at most four.
+#define BOARD_DIRTY_MAX 64
+
+/// what a cell held before board_set changed it, and for an empty cell,
+/// where it sat in free_cells.
+typedef struct
+{
+    uint32_t free_pos;
+    uint16_t x;
+    uint16_t y;
+    uint8_t type;
+} board_change_t;
+
+/// about what a flat copy moves in the time it takes to undo one change,
+/// snake_rewind copies instead once that is the quicker of the two.
+#define BOARD_UNDO_BYTES 384
+
+typedef struct
+{
+    uint32_t score;
+
+    /// live items are kept packed in items[0, item_count).
+    uint32_t item_count;
+    uint32_t item_max;
+    board_item_t *items;
+
+    /// slot in items of the item on each padded cell (only valid for item
+    /// cells). item_max comes from the uint16 item_goal, so slots fit.
+    uint16_t *item_at;
+
+    uint16_t rows;
+    uint16_t columns;
+
+    /// distance in bytes between each row of cells, padding included.
+    uint32_t stride;
+
+    /// first playable cell, cells[x * stride + y].
+    /// surrounded by BOARD_PADDING cells of wall on every side.
+    uint8_t *cells;
+
+    /// occupancy bitsets, kept in sync with cells by board_set.
+    bitboard_t bits;
+
+    /// every empty cell by padded index, in no order.
+    /// filled cells are swap-removed so sampling is O(1) at any fill level.
+    uint32_t *free_cells;
+    /// where each padded cell sits in free_cells (only valid while empty).
+    uint32_t *free_pos;
+    uint32_t free_count;
+
+    /// padded index of every cell changed since the renderer last drew,
+    /// repeats included. set dirty_all instead once it is full.
+    uint32_t dirty[BOARD_DIRTY_MAX];
+    uint16_t dirty_count;
+    /// new game, restore or too many changes, nothing drawn is valid.
+    bool dirty_all;
+
+    /// connected regions of free (empty or item) cells, see board_region_size.
+    region_t region;
+
+    /// while set, every change board_set makes is recorded here so
+    /// snake_rewind can undo it. the caller owns it, journal_max entries.
+    board_change_t *journal;
+    uint32_t journal_count;
+    uint32_t journal_max;
+    /// changes were dropped, only snake_restore can go back now.
+    bool journal_full;
+
+    /// single allocation backing cells, items, bits, the free list
+    /// and the item index, all addressed relative to it.
+    void *data;
+    size_t data_size;
+} board_t;
+
+/// sentinel wall border around the board, so neighbour lookups
+/// of any playable cell never need a bounds check.
+#define BOARD_PADDING 1
+#define BOARD_ALIGN 64
+
+/// padded cells are indexed by uint32_t, so (rows + 2) * (columns + 2) must fit.
+#define BOARD_CELLS_MAX (UINT32_MAX / 2)
+
+static inline uint8_t board_get(const board_t * board, const uint16_t x, const uint16_t y)
+{
+    return board->cells[(size_t)x * board->stride + y];
+}
+
+static inline uint32_t board_bit_index(const board_t * board, const uint16_t x, const uint16_t y)
+{
+    return (x + BOARD_PADDING) * board->stride + (y + BOARD_PADDING);
+}
+
+static inline bool bitboard_test(const uint64_t * set, const uint32_t i)
+{
+    return (set[i >> 6] >> (i & 63)) & 1;
+}
+
+/// wall or snake, ie, moving here is game over.
+static inline bool board_blocked(const board_t * board, const uint32_t i)
+{
+    return ((board->bits.sets[BitSet_WALL][i >> 6] | board->bits.sets[BitSet_SNAKE][i >> 6]) >> (i & 63)) & 1;
+}
+
+/// called by board_set as a padded cell becomes free or stops being free.
+void board_region_free(board_t * board, const uint32_t i);
+void board_region_fill(board_t * board, const uint32_t i);
+
+/// the bitset each cell type lives in.
+static const uint8_t board_bitset_index[256] =
+{
+    [BoardCellType_EMPTY]       = BitSet_EMPTY,
+    [BoardCellType_WALL]        = BitSet_WALL,
+    [BoardCellType_SNAKEBODY]   = BitSet_SNAKE,
+    [BoardCellType_SNAKEHEAD]   = BitSet_SNAKE,
+    [BoardCellType_ITEM]        = BitSet_ITEM,
+};
+
+static inline void board_set(board_t * board, const uint16_t x, const uint16_t y, const BoardCellType type)
+{
+    uint8_t *cell = &board->cells[(size_t)x * board->stride + y];
+    const uint8_t old_set = board_bitset_index[*cell];
+    const uint8_t new_set = board_bitset_index[type];
+    const uint32_t i = board_bit_index(board, x, y);
+
+    if (*cell != type)
+    {
+        if (board->journal)
+        {
+            if (board->journal_count < board->journal_max)
+            {
+                const uint32_t free_pos = *cell == BoardCellType_EMPTY ? board->free_pos[i] : 0;
+                board->journal[board->journal_count++] = (board_change_t){ free_pos, x, y, *cell };
+            }
+            else
+            {
+                board->journal_full = true;
+            }
+        }
+
+        if (board->dirty_count < BOARD_DIRTY_MAX)
+        {
+            board->dirty[board->dirty_count++] = i;
+        }
+        else
+        {
+            board->dirty_all = true;
+        }
+    }
+
+    *cell = type;
+
+    const uint64_t bit = 1ULL << (i & 63);
+
+    board->bits.sets[old_set][i >> 6] &= ~bit;
+    board->bits.sets[new_set][i >> 6] |= bit;
+
+    if (old_set == new_set)
+    {
+        return;
+    }
+
+    /// empty <-> item moves nothing between regions.
+    const bool was_free = old_set == BitSet_EMPTY || old_set == BitSet_ITEM;
+    const bool now_free = new_set == BitSet_EMPTY || new_set == BitSet_ITEM;
+    if (was_free != now_free && !board->region.stale)
+    {
+        if (now_free)
+        {
+            board_region_free(board, i);
+        }
+        else
+        {
+            board_region_fill(board, i);
+        }
+    }
+
+    if (old_set == BitSet_EMPTY)
+    {
+        /// move the last free cell into the hole.
+        const uint32_t last = board->free_cells[--board->free_count];
+        board->free_cells[board->free_pos[i]] = last;
+        board->free_pos[last] = board->free_pos[i];
+    }
+    else if (new_set == BitSet_EMPTY)
+    {
+        board->free_pos[i] = board->free_count;
+        board->free_cells[board->free_count++] = i;
+    }
+}
+
+/// called by whoever draws the board once every dirty cell is drawn.
+static inline void board_clear_dirty(board_t * board)
+{
+    board->dirty_count = 0;
+    board->dirty_all = false;
+}
+
+/// mask of SnakeDirection bits whose neighbour of x,y is not a wall or snake.
+static inline uint8_t board_free_neighbours(const board_t * board, const uint16_t x, const uint16_t y)
+{
+    /// the padding means every neighbour of a playable cell has a bit.
+    const uint32_t i = board_bit_index(board, x, y);
+    uint8_t mask = 0;
+
+    mask |= !board_blocked(board, i - board->stride) << SnakeDirection_LEFT;
+    mask |= !board_blocked(board, i + 1) << SnakeDirection_DOWN;
+    mask |= !board_blocked(board, i + board->stride) << SnakeDirection_RIGHT;
+    mask |= !board_blocked(board, i - 1) << SnakeDirection_UP;
+
+    return mask;
+}
+
+typedef enum
+{
+    Player_NORMAL,
+    Player_AI,
+    /// moves come from game->replay.
+    Player_REPLAY,
+    /// breadth first search to the nearest item, see snake_ai.h.
+    Player_PATH,
+    /// follows a hamiltonian cycle, taking shortcuts, see snake_ai.h.
+    Player_CYCLE,
+    /// monte carlo tree search on game->mcts, see snake_mcts.h.
+    Player_MCTS,
+    /// Player_AI, but never into a free region smaller than the snake.
+    Player_ROOM,
+} Player;
+
+/// one block per game, sized for the board. the board and snake body
+/// are carved out of it, and a new game just starts again from 0.
+typedef struct
+{
+    uint8_t *base;
+    size_t capacity;
+    size_t used;
+} arena_t;
+
+/// scratch for the searching ai players, sized for the board and carved
+/// from the arena with it, so deciding a move never allocates.
+typedef struct
+{
+    /// padded cell indices waiting to be searched.
+    uint32_t *queue;
+    /// the move from the start that first reached each padded cell.
+    uint8_t *first;
+    /// the move that entered each padded cell, to walk a path back.
+    uint8_t *from;
+    /// bit per padded cell, same layout as the board's bitsets.
+    uint64_t *visited;
+    /// where the snake would be after a planned path, same layout.
+    uint64_t *blocked;
+
+    /// a hamiltonian cycle over the playable cells, built with the board.
+    /// position on the cycle of each padded cell (walls are never read).
+    uint32_t *cycle_order;
+    /// the SnakeDirection to the next cell on the cycle from each padded cell.
+    uint8_t *cycle_next;
+    /// cells on the cycle, 0 if the board has none (odd by odd),
+    /// UINT32_MAX until search_cycle_create has run for this game.
+    uint32_t cycle_length;
+    /// where Player_CYCLE last sent the head, UINT32_MAX if unknown.
+    /// the head arriving there means the body is still in cycle order.
+    uint32_t cycle_head;
+} search_t;
+
+/// owned by the frontend, opaque to the core.
+typedef struct renderer renderer_t;
+typedef struct io io_t;
+
+/// see snake_replay.h.
+typedef struct replay_writer replay_writer_t;
+typedef struct replay replay_t;
+
+/// see snake_mcts.h.
+typedef struct mcts mcts_t;
+
+typedef struct
+{
+    /// how many times a second the snake moves, in real time.
+    uint8_t tick_rate;
+
+    /// TODO: cleanly impliment this.
+    Player player_type;
+
+    /// play, pause or quit.
+    GameState state;
+
+    /// board size used by the next snake_new_game.
+    uint16_t rows;
+    uint16_t columns;
+
+    /// how many items to keep on the board at once.
+    uint16_t item_goal;
+
+    /// every random choice in the game comes from here.
+    rng_t rng;
+    /// what rng was seeded with by snake_new_game.
+    uint64_t seed;
+
+    /// set when the snake hits a wall or itself.
+    bool game_over;
+
+    /// last key pressed, consumed on the next move.
+    KeyType input;
+
+    /// backs the board, snake body and search scratch of the current game.
+    arena_t arena;
+
+    search_t search;
+
+    /// the main board.
+    board_t *board;
+
+    /// the snake size, body and direction.
+    snake_t *snake;
+
+    /// window, renderer and (unused) texture.
+    renderer_t *renderer;
+
+    /// joypad / controller structs.
+    io_t *io;
+
+    /// when set, every game and move is recorded to it.
+    replay_writer_t *recorder;
+
+    /// moves played back by Player_REPLAY.
+    replay_t *replay;
+
+    /// search threads used by Player_MCTS.
+    mcts_t *mcts;
+} game_t;
+
+bool snake_inbounds(board_t * board, const uint16_t x, const uint16_t y);
+/// monotonic time in seconds.
+double snake_get_time(void);
+/// online cpus, at least 1 even if the system can't say.
+uint32_t snake_cpu_count(void);
+/// argv[index] as a seed if the tool was given one, else the time.
+uint64_t snake_parse_seed(const int argc, char * argv[], const int index);
+
+/// number of empty cells left on the board, counted from the bitset.
+/// board->free_count is kept equal by board_set, this is what checks it.
+uint32_t board_free_count(const board_t * board);
+
+/// free cells reachable from padded cell i (itself included), 0 if it is
+/// wall or snake. near constant time, unless a move may have split a region.
+uint32_t board_region_size(board_t * board, const uint32_t i);
+/// same value for two free cells only if one can be reached from the other.
+uint32_t board_region_id(board_t * board, const uint32_t i);
+SnakeDirection snake_gen_rand_direction(rng_t * rng);
+/// places an item on a random empty cell, false if the board or items are full.
+bool board_gen_rand_item_pos(board_t * board, rng_t * rng, const ItemType type);
+/// removes the item at x,y (eaten or expired), the cell itself is left for the caller.
+board_item_t board_remove_item(board_t * board, const uint16_t x, const uint16_t y);
+
+game_t * snake_init(void);
+/// the same seed always plays out the same game.
+/// -1, and the current game kept, if the board has too many cells or
+/// there isn't the memory for it.
+int snake_new_game(game_t * game, const uint64_t seed);
+void snake_exit(game_t * game);
+
+/// bytes a snapshot of this game can take, enough for any point in the game.
+size_t snake_snapshot_size(const game_t * game);
+/// copies board, snake, items, score and rng into buffer, returns bytes used.
+size_t snake_snapshot(const game_t * game, void * buffer);
+/// flat copy back into a game with the same board size, no allocation.
+/// starts board->journal over, if there is one.
+bool snake_restore(game_t * game, const void * buffer);
+/// snake_restore of the snapshot last restored into game, but only undoing
+/// what board->journal recorded since, so it costs the ticks played rather
+/// than the board. a full restore without a journal, once it filled, or
+/// when that is quicker (a small board, see BOARD_UNDO_BYTES).
+bool snake_rewind(game_t * game, const void * buffer);
+
+/// tops the board up to item_goal items, as each tick starts with.
+/// false (and game over) once the snake has filled the board.
+bool snake_spawn_items(game_t * game);
+/// move the snake a single tick.
+void snake_step(game_t * game);
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "snake_env.h"
+
+/// actions go through the same filter as key presses.
+static const KeyType env_keys[4] =
+{
+    [SnakeDirection_LEFT]   = KeyType_LEFT,
+    [SnakeDirection_DOWN]   = KeyType_DOWN,
+    [SnakeDirection_RIGHT]  = KeyType_RIGHT,
+    [SnakeDirection_UP]     = KeyType_UP,
+};
+
+/// bit per EnvPlane for each BoardCellType.
+static const uint8_t env_cell_planes[256] =
+{
+    [BoardCellType_WALL]        = 1 << EnvPlane_WALL,
+    [BoardCellType_SNAKEBODY]   = 1 << EnvPlane_BODY,
+    [BoardCellType_SNAKEHEAD]   = 1 << EnvPlane_HEAD,
+    [BoardCellType_ITEM]        = 1 << EnvPlane_ITEM,
+};
+
+static inline void env_write_cell(uint8_t * obs, const size_t plane, const size_t k, const uint8_t type)
+{
+    const uint8_t planes = env_cell_planes[type];
+
+    obs[EnvPlane_WALL * plane + k] = planes >> EnvPlane_WALL & 1;
+    obs[EnvPlane_BODY * plane + k] = planes >> EnvPlane_BODY & 1;
+    obs[EnvPlane_HEAD * plane + k] = planes >> EnvPlane_HEAD & 1;
+    obs[EnvPlane_ITEM * plane + k] = planes >> EnvPlane_ITEM & 1;
+}
+
+/// writes the cells changed since the last call, or all of them after a
+/// new game, using the same dirty list the renderers draw from.
+static void env_observe(env_t * env, const uint32_t g)
+{
+    board_t *board = env->games[g]->board;
+    uint8_t *obs = env->out.obs + g * env->obs_size;
+    const size_t plane = (size_t)board->rows * board->columns;
+
+    if (board->dirty_all)
+    {
+        for (uint16_t x = 0; x < board->rows; x++)
+        {
+            for (uint16_t y = 0; y < board->columns; y++)
+            {
+                env_write_cell(obs, plane, (size_t)x * board->columns + y, board_get(board, x, y));
+            }
+        }
+    }
+    else
+    {
+        for (uint16_t i = 0; i < board->dirty_count; i++)
+        {
+            const uint16_t x = board->dirty[i] / board->stride - BOARD_PADDING;
+            const uint16_t y = board->dirty[i] % board->stride - BOARD_PADDING;
+
+            env_write_cell(obs, plane, (size_t)x * board->columns + y, board_get(board, x, y));
+        }
+    }
+
+    board_clear_dirty(board);
+}
+
+static int env_new_game(env_t * env, const uint32_t g, const uint64_t seed)
+{
+    game_t *game = env->games[g];
+
+    if (snake_new_game(game, seed))
+    {
+        return -1;
+    }
+
+    game->state = GameState_PLAY;
+    game->player_type = Player_NORMAL;
+    /// so the first observation already shows the items.
+    snake_spawn_items(game);
+
+    env->seeds[g] = seed;
+    env->ticks[g] = 0;
+    return 0;
+}
+
+env_t * env_create(const env_config_t * config, const env_buffers_t * out)
+{
+    assert(config); assert(out);
+    assert(config->batch); assert(out->obs); assert(out->reward); assert(out->done);
+
+    env_t *env = calloc(1, sizeof(env_t));
+    assert(env);
+
+    env->config = *config;
+    env->config.seed_step = config->seed_step ? config->seed_step : config->batch;
+    env->out = *out;
+    env->obs_size = (size_t)EnvPlane_MAX * config->rows * config->columns;
+
+    env->games = calloc(config->batch, sizeof(game_t *));
+    env->seeds = calloc(config->batch, sizeof(uint64_t));
+    env->ticks = calloc(config->batch, sizeof(uint32_t));
+    assert(env->games); assert(env->seeds); assert(env->ticks);
+
+    for (uint32_t g = 0; g < config->batch; g++)
+    {
+        game_t *game = snake_init();
+        game->rows = config->rows;
+        game->columns = config->columns;
+        game->item_goal = config->item_goal ? config->item_goal : 1;
+        env->games[g] = game;
+
+        /// sizes the game's arena now, a board too big fails here
+        /// rather than on the first reset.
+        if (env_new_game(env, g, g))
+        {
+            env_destroy(env);
+            return NULL;
+        }
+    }
+
+    return env;
+}
+
+void env_destroy(env_t * env)
+{
+    assert(env);
+
+    for (uint32_t g = 0; g < env->config.batch; g++)
+    {
+        if (env->games[g])
+        {
+            snake_exit(env->games[g]);
+        }
+    }
+
+    free(env->games);
+    free(env->seeds);
+    free(env->ticks);
+    free(env);
+}
+
+int env_reset(env_t * env, const uint64_t * seeds)
+{
+    assert(env); assert(seeds);
+
+    for (uint32_t g = 0; g < env->config.batch; g++)
+    {
+        if (env_new_game(env, g, seeds[g]))
+        {
+            return -1;
+        }
+
+        env_observe(env, g);
+
+        env->out.reward[g] = 0;
+        env->out.done[g] = 0;
+        if (env->out.truncated)
+        {
+            env->out.truncated[g] = 0;
+        }
+    }
+
+    return 0;
+}
+
+void env_step(env_t * env, const uint8_t * actions)
+{
+    assert(env); assert(actions);
+
+    for (uint32_t g = 0; g < env->config.batch; g++)
+    {
+        game_t *game = env->games[g];
+        board_t *board = game->board;
+        const uint32_t score = board->score;
+
+        game->input = env_keys[actions[g] & 3];
+        snake_step(game);
+        env->ticks[g]++;
+
+        /// top up now rather than at the start of the next step, so the
+        /// observation shows what the next move will see.
+        if (!game->game_over)
+        {
+            snake_spawn_items(game);
+        }
+
+        float reward = board->score - score;
+        bool truncated = false;
+
+        if (game->game_over)
+        {
+            /// a full board ends the game too, that isn't a death.
+            if (board->free_count || board->item_count)
+            {
+                reward -= 1;
+            }
+        }
+        else if (env->config.tick_limit && env->ticks[g] >= env->config.tick_limit)
+        {
+            truncated = true;
+        }
+
+        const bool done = game->game_over || truncated;
+        if (done)
+        {
+            /// same board as the last episode, its arena already fits.
+            const int err = env_new_game(env, g, env->seeds[g] + env->config.seed_step);
+            assert(err == 0); (void)err;
+        }
+
+        env_observe(env, g);
+
+        env->out.reward[g] = reward;
+        env->out.done[g] = done;
+        if (env->out.truncated)
+        {
+            env->out.truncated[g] = truncated;
+        }
+    }
+}
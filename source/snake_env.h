@@ -0,0 +1,82 @@
+#pragma once
+
+#include "snake_core.h"
+
+/// reinforcement learning environment, a batch of games stepped together.
+/// observations, rewards and dones are written straight into buffers the
+/// caller owns, laid out so they can be wrapped as tensors without a copy.
+/// nothing is allocated after env_create.
+///
+/// a game that ends is reset on the same step (its seed moves on by
+/// seed_step), so the observation written with done set is the first of
+/// the next episode.
+
+typedef enum
+{
+    EnvPlane_WALL,
+    EnvPlane_BODY,
+    EnvPlane_HEAD,
+    EnvPlane_ITEM,
+    EnvPlane_MAX,
+} EnvPlane;
+
+typedef struct
+{
+    uint32_t batch;
+    uint16_t rows;
+    uint16_t columns;
+    uint16_t item_goal;
+    /// steps before an episode is cut short, 0 for never.
+    uint32_t tick_limit;
+    /// added to a game's seed each time it resets, 0 for batch. envs
+    /// sharing a seed range use the total game count to never repeat one.
+    uint64_t seed_step;
+} env_config_t;
+
+/// caller owned, one entry (or observation) per game in batch order.
+typedef struct
+{
+    /// uint8 [batch][EnvPlane_MAX][rows][columns], 1 where the cell is
+    /// that kind, else 0. only the cells that changed are written each step,
+    /// so nothing else may write to it between env_reset and env_step.
+    uint8_t *obs;
+    /// +1 for each item eaten, -1 for dying.
+    float *reward;
+    /// 1 if the episode ended on this step.
+    uint8_t *done;
+    /// 1 if it ended only because of tick_limit, may be NULL.
+    uint8_t *truncated;
+} env_buffers_t;
+
+typedef struct
+{
+    env_config_t config;
+    env_buffers_t out;
+
+    game_t **games;
+    /// seed of each game's current episode.
+    uint64_t *seeds;
+    /// steps into each game's current episode.
+    uint32_t *ticks;
+
+    /// bytes of one game's observation.
+    size_t obs_size;
+} env_t;
+
+/// bytes env_buffers_t.obs needs for config.
+static inline size_t env_obs_size(const env_config_t * config)
+{
+    return (size_t)config->batch * EnvPlane_MAX * config->rows * config->columns;
+}
+
+/// NULL if a game can't be made for config (see snake_new_game).
+env_t * env_create(const env_config_t * config, const env_buffers_t * out);
+void env_destroy(env_t * env);
+
+/// starts game i from seeds[i] and writes every observation in full.
+/// reward, done and truncated are cleared. -1 if a game can't be made.
+int env_reset(env_t * env, const uint64_t * seeds);
+
+/// moves game i towards SnakeDirection actions[i] (turning back is
+/// ignored, as with the keys) and writes its reward, done and observation.
+void env_step(env_t * env, const uint8_t * actions);
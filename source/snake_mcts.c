@@ -0,0 +1,505 @@
+#include "snake_mcts.h"
+#include "snake_ai.h"
+
+#include <math.h>
+
+/// exploration weight of ucb1, values are in [0, 1].
+#define MCTS_EXPLORE 0.7f
+/// moves followed down the tree in one iteration.
+#define MCTS_TREE_DEPTH 64
+/// rollout ticks played between looks at the clock.
+#define MCTS_CLOCK_TICKS 8
+/// board changes journaled per tick of an iteration, a tick touches at most
+/// four cells. an iteration that changes more falls back to a full restore.
+#define MCTS_JOURNAL_TICK 4
+/// seconds kept back from the budget to stop the workers and count
+/// their votes, a few times what that takes.
+#define MCTS_RESERVE 20e-6
+
+/// a rollout is worth MCTS_ALIVE for surviving it and up to MCTS_EAT for
+/// eating, more the sooner the first item is reached. dying after an
+/// early item still scores below surviving without one.
+#define MCTS_ALIVE 0.6f
+#define MCTS_EAT 0.4f
+
+/// free directions from the head, a blocked move is always death.
+static uint8_t mcts_moves(const game_t * game)
+{
+    const snake_body_t head = game->snake->body[game->snake->h_pos];
+    return board_free_neighbours(game->board, head.x, head.y);
+}
+
+static void mcts_play(game_t * game, const SnakeDirection direction)
+{
+    /// the moves are already legal, as with replays no need to filter them.
+    game->snake->buffered_direction = direction;
+    snake_step(game);
+}
+
+/// mostly steps towards the nearest item, sometimes anywhere free.
+static SnakeDirection mcts_rollout_move(game_t * game, rng_t * rng)
+{
+    const board_t *board = game->board;
+    const snake_body_t head = game->snake->body[game->snake->h_pos];
+    const uint8_t moves = board_free_neighbours(board, head.x, head.y);
+
+    if (!moves)
+    {
+        return head.direction;
+    }
+
+    uint8_t choices[4];
+    uint8_t count = 0;
+    for (uint8_t d = 0; d < 4; d++)
+    {
+        if (moves & (1 << d))
+        {
+            choices[count++] = d;
+        }
+    }
+
+    if (rng_range(rng, 4) == 0 || !board->item_count)
+    {
+        return choices[rng_range(rng, count)];
+    }
+
+    /// manhattan distance to the nearest item after each free move.
+    SnakeDirection best = choices[0];
+    uint32_t best_distance = UINT32_MAX;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        int x = head.x, y = head.y;
+        switch (choices[i])
+        {
+            case SnakeDirection_LEFT:   x--;    break;
+            case SnakeDirection_DOWN:   y++;    break;
+            case SnakeDirection_RIGHT:  x++;    break;
+            case SnakeDirection_UP:     y--;    break;
+        }
+
+        for (uint32_t j = 0; j < board->item_count; j++)
+        {
+            const uint32_t distance = abs(board->items[j].x - x) + abs(board->items[j].y - y);
+            if (distance < best_distance)
+            {
+                best_distance = distance;
+                best = choices[i];
+            }
+        }
+    }
+
+    return best;
+}
+
+/// filling the board ends the game too, but that is a win.
+static inline bool mcts_dead(const game_t * game)
+{
+    return game->game_over && (game->board->free_count || game->board->item_count);
+}
+
+/// past the deadline, or told to stop.
+static inline bool mcts_expired(const mcts_t * mcts)
+{
+    return atomic_load_explicit(&mcts->stop, memory_order_relaxed) || snake_get_time() >= mcts->deadline;
+}
+
+/// the rollout's value, or below 0 if it was cut short by the deadline.
+static float mcts_rollout(mcts_worker_t * worker, const uint32_t start_score)
+{
+    game_t *game = worker->game;
+    const uint32_t depth = worker->mcts->config.rollout_depth;
+
+    uint32_t first_eat = depth + 1;
+    if (game->board->score != start_score)
+    {
+        first_eat = 0;
+    }
+
+    for (uint32_t t = 0; t < depth && !game->game_over; t++)
+    {
+        if (t % MCTS_CLOCK_TICKS == MCTS_CLOCK_TICKS - 1 && mcts_expired(worker->mcts))
+        {
+            return -1.0f;
+        }
+
+        mcts_play(game, mcts_rollout_move(game, &worker->rng));
+
+        if (first_eat > depth && game->board->score != start_score)
+        {
+            first_eat = t + 1;
+        }
+    }
+
+    const float eat = first_eat <= depth ? 1.0f - (float)first_eat / (depth + 1) : 0.0f;
+    return (mcts_dead(game) ? 0.0f : MCTS_ALIVE) + MCTS_EAT * eat;
+}
+
+/// ucb1 over the children of node that are free moves in the current game.
+/// an untried move is picked before any tried one.
+static SnakeDirection mcts_select(const mcts_worker_t * worker, const mcts_node_t * node, const uint8_t moves)
+{
+    const float log_visits = logf((float)node->visits + 1.0f);
+    SnakeDirection best = SnakeDirection_UP;
+    float best_score = -1.0f;
+
+    for (uint8_t d = 0; d < 4; d++)
+    {
+        if (!(moves & (1 << d)))
+        {
+            continue;
+        }
+
+        if (!node->child[d])
+        {
+            return d;
+        }
+
+        const mcts_node_t *child = &worker->nodes[node->child[d]];
+        const float score = child->value / child->visits + MCTS_EXPLORE * sqrtf(log_visits / child->visits);
+
+        if (score > best_score)
+        {
+            best_score = score;
+            best = d;
+        }
+    }
+
+    return best;
+}
+
+static void mcts_iteration(mcts_worker_t * worker)
+{
+    mcts_t *mcts = worker->mcts;
+    game_t *game = worker->game;
+
+    const bool restored = snake_rewind(game, mcts->root);
+    assert(restored); (void)restored;
+    game->input = KeyType_NONE;
+
+    /// a spawn is a guess, every iteration guesses again.
+    rng_seed(&game->rng, ((uint64_t)rng_next(&worker->rng) << 32) | rng_next(&worker->rng));
+
+    const uint32_t start_score = game->board->score;
+
+    uint32_t path[MCTS_TREE_DEPTH + 2];
+    uint32_t path_count = 0;
+    uint32_t node = 0;
+    path[path_count++] = node;
+
+    /// the node added this iteration, taken back out if it is cut short.
+    uint32_t parent = 0;
+    SnakeDirection added = SnakeDirection_UP;
+    bool expanded = false;
+
+    /// follow the tree down, adding one node where it ends.
+    while (!game->game_over && path_count <= MCTS_TREE_DEPTH)
+    {
+        if (path_count % MCTS_CLOCK_TICKS == 0 && mcts_expired(mcts))
+        {
+            return;
+        }
+
+        const uint8_t moves = mcts_moves(game);
+        if (!moves)
+        {
+            mcts_play(game, game->snake->body[game->snake->h_pos].direction);
+            break;
+        }
+
+        const SnakeDirection d = mcts_select(worker, &worker->nodes[node], moves);
+        const bool expand = !worker->nodes[node].child[d];
+
+        if (expand)
+        {
+            if (worker->node_count == MCTS_NODE_MAX)
+            {
+                break;
+            }
+
+            const uint32_t child = worker->node_count++;
+            memset(&worker->nodes[child], 0, sizeof(mcts_node_t));
+            worker->nodes[node].child[d] = child;
+
+            parent = node;
+            added = d;
+            expanded = true;
+        }
+
+        node = worker->nodes[node].child[d];
+        path[path_count++] = node;
+        mcts_play(game, d);
+
+        if (expand)
+        {
+            break;
+        }
+    }
+
+    const float value = mcts_rollout(worker, start_score);
+
+    /// a node without visits would never be selected again.
+    if (value < 0.0f)
+    {
+        if (expanded)
+        {
+            worker->nodes[parent].child[added] = 0;
+            worker->node_count--;
+        }
+
+        return;
+    }
+
+    for (uint32_t i = 0; i < path_count; i++)
+    {
+        worker->nodes[path[i]].visits++;
+        worker->nodes[path[i]].value += value;
+    }
+
+    worker->rollouts++;
+}
+
+static void mcts_search(mcts_worker_t * worker)
+{
+    mcts_t *mcts = worker->mcts;
+
+    /// a worker's copy only needs to match the root's board size and item slots.
+    worker->game->item_goal = mcts->item_goal;
+    if (worker->game->board->rows != mcts->rows || worker->game->board->columns != mcts->columns || \
+        worker->game->board->item_max != mcts->item_max)
+    {
+        worker->game->rows = mcts->rows;
+        worker->game->columns = mcts->columns;
+        snake_new_game(worker->game, 0);
+    }
+
+    worker->game->player_type = Player_NORMAL;
+
+    /// the only full copy of the root this decision, iterations rewind to it.
+    const bool restored = snake_restore(worker->game, mcts->root);
+    assert(restored); (void)restored;
+
+    memset(&worker->nodes[0], 0, sizeof(mcts_node_t));
+    worker->node_count = 1;
+
+    /// an iteration still going at the deadline is dropped in its rollout.
+    while (!mcts_expired(mcts))
+    {
+        mcts_iteration(worker);
+    }
+}
+
+static void * mcts_thread(void * arg)
+{
+    mcts_worker_t *worker = arg;
+    mcts_t *mcts = worker->mcts;
+    uint64_t seen = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&mcts->lock);
+        while (mcts->generation == seen && !mcts->quit)
+        {
+            pthread_cond_wait(&mcts->start, &mcts->lock);
+        }
+
+        if (mcts->quit)
+        {
+            pthread_mutex_unlock(&mcts->lock);
+            return NULL;
+        }
+
+        seen = mcts->generation;
+        pthread_mutex_unlock(&mcts->lock);
+
+        mcts_search(worker);
+
+        pthread_mutex_lock(&mcts->lock);
+        if (++mcts->finished == mcts->worker_count - 1)
+        {
+            pthread_cond_signal(&mcts->done);
+        }
+        pthread_mutex_unlock(&mcts->lock);
+    }
+}
+
+mcts_t * mcts_create(const mcts_config_t * config)
+{
+    assert(config); assert(config->budget > 0);
+
+    mcts_t *mcts = aligned_alloc(_Alignof(mcts_t), sizeof(mcts_t));
+    assert(mcts);
+    memset(mcts, 0, sizeof(mcts_t));
+
+    mcts->config = *config;
+    mcts->worker_count = config->threads ? config->threads : snake_cpu_count();
+
+    mcts->workers = aligned_alloc(_Alignof(mcts_worker_t), mcts->worker_count * sizeof(mcts_worker_t));
+    assert(mcts->workers);
+    memset(mcts->workers, 0, mcts->worker_count * sizeof(mcts_worker_t));
+
+    pthread_mutex_init(&mcts->lock, NULL);
+    pthread_cond_init(&mcts->start, NULL);
+    pthread_cond_init(&mcts->done, NULL);
+    atomic_init(&mcts->stop, false);
+
+    for (uint32_t i = 0; i < mcts->worker_count; i++)
+    {
+        mcts_worker_t *worker = &mcts->workers[i];
+        worker->mcts = mcts;
+        rng_seed(&worker->rng, config->seed + i);
+        worker->game = snake_init();
+        worker->nodes = malloc(MCTS_NODE_MAX * sizeof(mcts_node_t));
+        assert(worker->nodes);
+
+        /// enough for every tick an iteration can play.
+        board_t *board = worker->game->board;
+        board->journal_max = MCTS_JOURNAL_TICK * (MCTS_TREE_DEPTH + 2 + config->rollout_depth);
+        board->journal = malloc(board->journal_max * sizeof(board_change_t));
+        assert(board->journal);
+    }
+
+    /// worker 0 runs on the thread asking for a move.
+    for (uint32_t i = 1; i < mcts->worker_count; i++)
+    {
+        if (pthread_create(&mcts->workers[i].thread, NULL, mcts_thread, &mcts->workers[i]) != 0)
+        {
+            /// mcts_destroy joins and frees only the workers that started.
+            for (uint32_t j = i; j < mcts->worker_count; j++)
+            {
+                free(mcts->workers[j].game->board->journal);
+                snake_exit(mcts->workers[j].game);
+                free(mcts->workers[j].nodes);
+            }
+
+            mcts->worker_count = i;
+            mcts_destroy(mcts);
+            return NULL;
+        }
+    }
+
+    return mcts;
+}
+
+void mcts_destroy(mcts_t * mcts)
+{
+    assert(mcts);
+
+    pthread_mutex_lock(&mcts->lock);
+    mcts->quit = true;
+    pthread_cond_broadcast(&mcts->start);
+    pthread_mutex_unlock(&mcts->lock);
+
+    for (uint32_t i = 0; i < mcts->worker_count; i++)
+    {
+        if (i)
+        {
+            pthread_join(mcts->workers[i].thread, NULL);
+        }
+
+        free(mcts->workers[i].game->board->journal);
+        snake_exit(mcts->workers[i].game);
+        free(mcts->workers[i].nodes);
+    }
+
+    pthread_cond_destroy(&mcts->done);
+    pthread_cond_destroy(&mcts->start);
+    pthread_mutex_destroy(&mcts->lock);
+
+    free(mcts->root);
+    free(mcts->workers);
+    free(mcts);
+}
+
+SnakeDirection snake_ai_mcts(game_t * game)
+{
+    assert(game);
+
+    mcts_t *mcts = game->mcts;
+    if (!mcts)
+    {
+        return snake_ai_path(game);
+    }
+
+    const double start = snake_get_time();
+
+    const size_t size = snake_snapshot_size(game);
+    if (size > mcts->root_size)
+    {
+        free(mcts->root);
+        mcts->root = malloc(size);
+        assert(mcts->root);
+        mcts->root_size = size;
+    }
+
+    snake_snapshot(game, mcts->root);
+    mcts->rows = game->board->rows;
+    mcts->columns = game->board->columns;
+    mcts->item_goal = game->item_goal;
+    mcts->item_max = game->board->item_max;
+    const double deadline = start + mcts->config.budget;
+    mcts->deadline = deadline - MCTS_RESERVE;
+
+    pthread_mutex_lock(&mcts->lock);
+    atomic_store_explicit(&mcts->stop, false, memory_order_relaxed);
+    mcts->finished = 0;
+    mcts->generation++;
+    pthread_cond_broadcast(&mcts->start);
+    pthread_mutex_unlock(&mcts->lock);
+
+    mcts_search(&mcts->workers[0]);
+
+    /// the others give up within a few rollout ticks.
+    atomic_store_explicit(&mcts->stop, true, memory_order_relaxed);
+
+    pthread_mutex_lock(&mcts->lock);
+    while (mcts->finished != mcts->worker_count - 1)
+    {
+        pthread_cond_wait(&mcts->done, &mcts->lock);
+    }
+    pthread_mutex_unlock(&mcts->lock);
+
+    /// the root move most visited over every tree.
+    uint64_t visits[4] = {0};
+    uint64_t rollouts = 0;
+
+    for (uint32_t i = 0; i < mcts->worker_count; i++)
+    {
+        const mcts_worker_t *worker = &mcts->workers[i];
+        for (uint8_t d = 0; d < 4; d++)
+        {
+            if (worker->nodes[0].child[d])
+            {
+                visits[d] += worker->nodes[worker->nodes[0].child[d]].visits;
+            }
+        }
+
+        rollouts += worker->rollouts;
+    }
+
+    SnakeDirection best = game->snake->body[game->snake->h_pos].direction;
+    uint64_t most = 0;
+    for (uint8_t d = 0; d < 4; d++)
+    {
+        if (visits[d] > most)
+        {
+            most = visits[d];
+            best = d;
+        }
+    }
+
+    const double end = snake_get_time();
+
+    mcts->stats.decisions++;
+    mcts->stats.rollouts = rollouts;
+    mcts->stats.search_time += end - start;
+
+    if (end > deadline)
+    {
+        mcts->stats.overruns++;
+        mcts->stats.overrun_max = end - deadline > mcts->stats.overrun_max ? end - deadline : mcts->stats.overrun_max;
+    }
+
+    /// nothing searched at all, the budget is too small for one rollout.
+    return most ? best : snake_ai_path(game);
+}
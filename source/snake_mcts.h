@@ -0,0 +1,111 @@
+#pragma once
+
+#include "snake_core.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/// monte carlo tree search player. every decision, each worker restores
+/// the current game into its own copy and runs rollouts from it until the
+/// time budget is spent, building its own tree of moves (root parallel,
+/// nothing is shared while searching). the root move visited most across
+/// every worker is played.
+///
+/// item spawns are not known ahead of time, so every rollout reseeds its
+/// copy's rng from the worker's own rng, and the tree is over moves only.
+
+/// nodes in each worker's tree, a full tree just stops growing.
+#define MCTS_NODE_MAX (1 << 15)
+
+typedef struct
+{
+    /// 0 uses every online cpu.
+    uint32_t threads;
+    /// seconds a decision may take, from the call to the move returned.
+    double budget;
+    /// ticks played past the tree before a rollout is scored.
+    uint32_t rollout_depth;
+    /// seeds each worker's rng.
+    uint64_t seed;
+} mcts_config_t;
+
+typedef struct
+{
+    /// child node for each SnakeDirection, 0 for none (0 is the root).
+    uint32_t child[4];
+    uint32_t visits;
+    float value;
+} mcts_node_t;
+
+typedef struct mcts_worker mcts_worker_t;
+
+typedef struct
+{
+    uint64_t decisions;
+    uint64_t rollouts;
+    /// wall time spent deciding.
+    double search_time;
+    /// decisions that returned after their deadline, and by how much at worst.
+    uint64_t overruns;
+    double overrun_max;
+} mcts_stats_t;
+
+struct mcts_worker
+{
+    /// own cache line, only the owner writes while searching.
+    _Alignas(64) rng_t rng;
+    uint64_t rollouts;
+
+    /// restored from the root at the start of every decision, and
+    /// rewound to it through its board's journal every iteration.
+    game_t *game;
+    mcts_node_t *nodes;
+    uint32_t node_count;
+
+    struct mcts *mcts;
+    pthread_t thread;
+};
+
+struct mcts
+{
+    mcts_config_t config;
+
+    uint32_t worker_count;
+    mcts_worker_t *workers;
+
+    /// snapshot of the game being decided, read only while searching.
+    uint8_t *root;
+    size_t root_size;
+    uint16_t rows;
+    uint16_t columns;
+    uint16_t item_goal;
+    uint32_t item_max;
+    /// when searching stops, a little before the decision is due.
+    double deadline;
+
+    /// bumped to start a search, workers sleep on start until it changes.
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint64_t generation;
+    uint32_t finished;
+    bool quit;
+    /// set once the calling thread's own search ends.
+    _Atomic bool stop;
+
+    mcts_stats_t stats;
+};
+
+/// starts the worker threads, they sleep until a decision is asked for.
+/// NULL if they can't all be started.
+mcts_t * mcts_create(const mcts_config_t * config);
+void mcts_destroy(mcts_t * mcts);
+
+/// the move for game->snake, searched within game->mcts->config.budget.
+/// the calling thread searches too. without game->mcts this is snake_ai_path.
+SnakeDirection snake_ai_mcts(game_t * game);
+
+static inline double mcts_rollouts_per_sec(const mcts_t * mcts)
+{
+    return mcts->stats.search_time > 0 ? mcts->stats.rollouts / mcts->stats.search_time : 0;
+}
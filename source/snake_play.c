@@ -0,0 +1,200 @@
+#include "snake.h"
+#include "snake_replay.h"
+#include "snake_mcts.h"
+
+#define ROWS    20
+#define COLUMNS 20
+#define SCALE   30
+
+#define WIN_W    ROWS * SCALE
+#define WIN_H    COLUMNS * SCALE
+
+/// ticks owed after a stall (window drag, debugger) beyond this are dropped
+/// rather than played back in a burst.
+#define MAX_CATCHUP 5
+
+/// frames the capture writer can fall behind by before frames are dropped.
+#define CAPTURE_SLOTS 16
+
+typedef struct
+{
+    double start;
+    double last_tick;
+    double interval_sum;
+    double jitter_max;
+    uint64_t frames;
+    uint64_t ticks;
+    uint64_t dropped;
+} play_stats_t;
+
+static void stats_tick(play_stats_t * stats, const double period)
+{
+    const double now = snake_get_time();
+
+    if (stats->ticks)
+    {
+        const double interval = now - stats->last_tick;
+        const double jitter = interval > period ? interval - period : period - interval;
+
+        stats->interval_sum += interval;
+        if (jitter > stats->jitter_max)
+        {
+            stats->jitter_max = jitter;
+        }
+    }
+
+    stats->last_tick = now;
+    stats->ticks++;
+}
+
+static void stats_print(const play_stats_t * stats, const double period)
+{
+    const double elapsed = snake_get_time() - stats->start;
+    const double cpu = (double)clock() / CLOCKS_PER_SEC;
+
+    printf("elapsed:     %.3fs\n", elapsed);
+    printf("frames:      %llu (%.1f fps)\n", (unsigned long long)stats->frames, elapsed > 0 ? stats->frames / elapsed : 0.0);
+    printf("ticks:       %llu (%llu dropped)\n", (unsigned long long)stats->ticks, (unsigned long long)stats->dropped);
+    printf("tick period: %.2fms (mean %.2fms, max jitter %.2fms)\n", period * 1000.0,
+        stats->ticks > 1 ? stats->interval_sum / (stats->ticks - 1) * 1000.0 : 0.0, stats->jitter_max * 1000.0);
+    printf("cpu:         %.1f%%\n", elapsed > 0 ? cpu / elapsed * 100.0 : 0.0);
+}
+
+static inline void snake_run(game_t * game, play_stats_t * stats, const double period)
+{
+    /// blocks until a tick is due or an event arrives.
+    uint32_t ticks = snake_poll(game);
+
+    if (ticks > MAX_CATCHUP)
+    {
+        stats->dropped += ticks - MAX_CATCHUP;
+        ticks = MAX_CATCHUP;
+    }
+
+    uint32_t played = 0;
+    for (uint32_t i = 0; i < ticks && game->state == GameState_PLAY; i++, played++)
+    {
+        const bool was_over = game->game_over;
+        snake_step(game);
+        if (!was_over && game->game_over)
+        {
+            printf("game over\n");
+        }
+
+        stats_tick(stats, period);
+    }
+
+    /// paused, in the menu or woken with nothing due, the last frame still stands.
+    if (played == 0 && !game->renderer->redraw)
+    {
+        return;
+    }
+
+    snake_render(game);
+    stats->frames++;
+}
+
+void snake_play(const char * record_path, const char * capture_path)
+{
+    game_t *game = snake_init();
+
+    game->renderer = calloc(1, sizeof(renderer_t));
+    assert(game->renderer);
+
+    game->io = calloc(1, sizeof(io_t));
+    assert(game->io);
+
+    if (record_path)
+    {
+        game->recorder = calloc(1, sizeof(replay_writer_t));
+        assert(game->recorder);
+
+        if (replay_writer_open(game->recorder, record_path))
+        {
+            fprintf(stderr, "failed to open %s, not recording\n", record_path);
+            free(game->recorder);
+            game->recorder = NULL;
+        }
+    }
+
+    snake_render_init(game->renderer, WIN_W, WIN_H);
+
+    if (capture_path)
+    {
+        /// aligned, the ring counters sit on their own cache lines.
+        game->renderer->capture = aligned_alloc(_Alignof(capture_t), sizeof(capture_t));
+        assert(game->renderer->capture);
+
+        /// frames are captured as presented, about one per tick.
+        if (capture_open(game->renderer->capture, capture_path, capture_format_from_path(capture_path),
+            game->renderer->clip.w, game->renderer->clip.h, game->tick_rate, CAPTURE_SLOTS))
+        {
+            fprintf(stderr, "failed to open %s, not capturing\n", capture_path);
+            free(game->renderer->capture);
+            game->renderer->capture = NULL;
+        }
+    }
+
+    snake_new_game(game, time(NULL));
+    game->state = GameState_PLAY;
+    game->player_type = Player_AI;
+
+    snake_poll_init(game);
+
+    /// the first frame, before any tick.
+    game->renderer->redraw = true;
+
+    const double period = 1.0 / game->tick_rate;
+
+    play_stats_t stats = {0};
+    stats.start = snake_get_time();
+
+    while (game->state != GameState_QUIT)
+    {
+        snake_run(game, &stats, period);
+    }
+
+    stats_print(&stats, period);
+
+    /// started by 'p' picking Player_MCTS, if it ever was.
+    if (game->mcts)
+    {
+        const mcts_stats_t *mcts = &game->mcts->stats;
+        printf("mcts:        %.0f rollouts/sec, %llu/%llu decisions late (worst %.2fms)\n", mcts_rollouts_per_sec(game->mcts),
+            (unsigned long long)mcts->overruns, (unsigned long long)mcts->decisions, mcts->overrun_max * 1000.0);
+
+        mcts_destroy(game->mcts);
+        game->mcts = NULL;
+    }
+
+    if (game->renderer->capture)
+    {
+        capture_t *capture = game->renderer->capture;
+        capture_close(capture);
+        printf("captured:    %llu frames (%llu dropped, %llu failed)\n", (unsigned long long)capture_written(capture),
+            (unsigned long long)capture->dropped, (unsigned long long)atomic_load(&capture->errors));
+        free(capture);
+        game->renderer->capture = NULL;
+    }
+
+    snake_poll_exit(game);
+    snake_render_exit(game->renderer);
+
+    if (game->recorder)
+    {
+        replay_writer_end(game->recorder, game);
+        if (replay_writer_close(game->recorder))
+        {
+            fprintf(stderr, "failed to write %s\n", record_path);
+        }
+        free(game->recorder);
+        game->recorder = NULL;
+    }
+
+    free(game->io);
+    game->io = NULL;
+    free(game->renderer);
+    game->renderer = NULL;
+
+    snake_exit(game);
+}
\ No newline at end of file
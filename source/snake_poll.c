@@ -1,4 +1,28 @@
 #include "snake.h"
+#include "snake_mcts.h"
+
+/// share of a tick Player_MCTS may spend deciding, the rest is for drawing.
+#define MCTS_BUDGET_SHARE 0.5
+
+/// the ai players the demo steps through, any other player starts at the first.
+/// the mcts threads are only started the first time it is picked.
+static Player next_ai_player(game_t * game)
+{
+    switch (game->player_type)
+    {
+        case Player_AI:     return Player_ROOM;
+        case Player_ROOM:   return Player_PATH;
+        case Player_PATH:   return Player_CYCLE;
+        case Player_CYCLE:
+            if (!game->mcts)
+            {
+                const mcts_config_t config = { .threads = 0, .budget = MCTS_BUDGET_SHARE / game->tick_rate, .rollout_depth = 40, .seed = time(NULL) };
+                game->mcts = mcts_create(&config);
+            }
+            return game->mcts ? Player_MCTS : Player_AI;
+        default:            return Player_AI;
+    }
+}
 
 #ifdef SDL2
 static void keyboard_update(game_t * game, const SDL_KeyboardEvent * e)
@@ -14,16 +38,16 @@ static void keyboard_update(game_t * game, const SDL_KeyboardEvent * e)
     {
         /// up,down,left,right
         case SDLK_LEFT: case SDLK_a:
-            game->io->type = KeyType_LEFT;
+            game->input = KeyType_LEFT;
             break;
         case SDLK_DOWN: case SDLK_s:
-            game->io->type = KeyType_DOWN;
+            game->input = KeyType_DOWN;
             break;
         case SDLK_RIGHT: case SDLK_d:
-            game->io->type = KeyType_RIGHT;
+            game->input = KeyType_RIGHT;
             break;
         case SDLK_UP: case SDLK_w:
-            game->io->type = KeyType_UP;
+            game->input = KeyType_UP;
             break;
 
         /// pause.
@@ -31,9 +55,37 @@ static void keyboard_update(game_t * game, const SDL_KeyboardEvent * e)
             game->state = game->state == GameState_PAUSE ? GameState_PLAY : GameState_PAUSE;
             break;
 
+        /// cycle through the ways of drawing the board.
+        case SDLK_t:
+            game->renderer->board_mode = (game->renderer->board_mode + 1) % BoardMode_MAX;
+            game->renderer->board_redraw = true;
+            break;
+
+        /// cycle through the ai players, mid game.
+        case SDLK_p:
+            game->player_type = next_ai_player(game);
+            break;
+
+        /// pan a board too big for the window, f follows the head again.
+        case SDLK_j:
+            snake_render_pan(game->renderer, -1, 0);
+            break;
+        case SDLK_l:
+            snake_render_pan(game->renderer, 1, 0);
+            break;
+        case SDLK_i:
+            snake_render_pan(game->renderer, 0, -1);
+            break;
+        case SDLK_k:
+            snake_render_pan(game->renderer, 0, 1);
+            break;
+        case SDLK_f:
+            snake_render_follow(game->renderer);
+            break;
+
         /// test reset.
         case SDLK_r:
-            snake_new_game(game);
+            snake_new_game(game, time(NULL));
             break;
 
         /// quit
@@ -158,52 +210,90 @@ static void cbutton_update(game_t * game, const SDL_ControllerButtonEvent * e)
     }
 }
 
-static void poll_sdl2(game_t * game)
+static void sdl2_event(game_t * game, SDL_Event * event)
 {
-    SDL_Event event = {0};
+    assert(game); assert(event);
 
-    while (SDL_PollEvent(&event))
+    switch (event->type)
     {
-        switch (event.type)
-        {
-            case SDL_QUIT:
-                game->state = GameState_QUIT;
-                break;
+        case SDL_QUIT:
+            game->state = GameState_QUIT;
+            break;
 
-            case SDL_KEYDOWN:
-                keyboard_update(game, &event.key);
-                break;
+        case SDL_KEYDOWN:
+            keyboard_update(game, &event->key);
+            game->renderer->redraw = true;
+            break;
 
-            // case SDL_JOYDEVICEADDED: case SDL_JOYDEVICEREMOVED:
-            //     joypad_connect(game->io, &event.jdevice);
-            //     break;
+        /// the board image is a render target, its contents are gone.
+        case SDL_RENDER_TARGETS_RESET: case SDL_RENDER_DEVICE_RESET:
+            game->renderer->board_redraw = true;
+            game->renderer->redraw = true;
+            break;
 
-            // case SDL_JOYHATMOTION:
-            //     jhat_update(game, &event.jhat);
-            //     break;
+        /// uncovered or resized by the window manager.
+        case SDL_WINDOWEVENT:
+            game->renderer->redraw = true;
+            break;
 
-            // case SDL_JOYBUTTONDOWN:
-            //     jbutton_update(game, &event.jbutton);
-            //     break;
+        // case SDL_JOYDEVICEADDED: case SDL_JOYDEVICEREMOVED:
+        //     joypad_connect(game->io, &event->jdevice);
+        //     break;
 
-            // case SDL_JOYAXISMOTION:
-            //     break;
+        // case SDL_JOYHATMOTION:
+        //     jhat_update(game, &event->jhat);
+        //     break;
 
-            case SDL_CONTROLLERDEVICEADDED: case SDL_CONTROLLERDEVICEREMOVED:
-                controller_connect(game->io, &event.cdevice);
-                break;
+        // case SDL_JOYBUTTONDOWN:
+        //     jbutton_update(game, &event->jbutton);
+        //     break;
 
-            case SDL_CONTROLLERBUTTONDOWN:
-                cbutton_update(game, &event.cbutton);
-                break;
+        // case SDL_JOYAXISMOTION:
+        //     break;
 
-            case SDL_CONTROLLERAXISMOTION:
-                break;
+        case SDL_CONTROLLERDEVICEADDED: case SDL_CONTROLLERDEVICEREMOVED:
+            controller_connect(game->io, &event->cdevice);
+            break;
 
-            default:
-                break;
-        }
+        case SDL_CONTROLLERBUTTONDOWN:
+            cbutton_update(game, &event->cbutton);
+            game->renderer->redraw = true;
+            break;
+
+        case SDL_CONTROLLERAXISMOTION:
+            break;
+
+        default:
+            break;
+    }
+}
+
+static uint32_t poll_sdl2(game_t * game)
+{
+    assert(game);
+
+    SDL_Event event = {0};
+
+    /// sleep until the next tick is due or something happens.
+    const int32_t wait = (int32_t)(game->io->next_tick - SDL_GetTicks());
+    if (wait > 0 && SDL_WaitEventTimeout(&event, wait))
+    {
+        sdl2_event(game, &event);
+    }
+
+    while (SDL_PollEvent(&event))
+    {
+        sdl2_event(game, &event);
+    }
+
+    uint32_t ticks = 0;
+    while ((int32_t)(SDL_GetTicks() - game->io->next_tick) >= 0)
+    {
+        game->io->next_tick += game->io->tick_ms;
+        ticks++;
     }
+
+    return ticks;
 }
 #endif
 
@@ -215,16 +305,44 @@ static void keyboard_update(game_t * game, ALLEGRO_KEYBOARD_EVENT * e)
     switch (e->keycode)
     {
         case ALLEGRO_KEY_UP: case ALLEGRO_KEY_W:
-            game->io->type = KeyType_UP;
+            game->input = KeyType_UP;
             break;
         case ALLEGRO_KEY_DOWN: case ALLEGRO_KEY_S:
-            game->io->type = KeyType_DOWN;
+            game->input = KeyType_DOWN;
             break;
         case ALLEGRO_KEY_LEFT: case ALLEGRO_KEY_A:
-            game->io->type = KeyType_LEFT;
+            game->input = KeyType_LEFT;
             break;
         case ALLEGRO_KEY_RIGHT: case ALLEGRO_KEY_D:
-            game->io->type = KeyType_RIGHT;
+            game->input = KeyType_RIGHT;
+            break;
+
+        /// cycle through the ways of drawing the board.
+        case ALLEGRO_KEY_T:
+            game->renderer->board_mode = (game->renderer->board_mode + 1) % BoardMode_MAX;
+            game->renderer->board_redraw = true;
+            break;
+
+        /// cycle through the ai players, mid game.
+        case ALLEGRO_KEY_P:
+            game->player_type = next_ai_player(game);
+            break;
+
+        /// pan a board too big for the window, f follows the head again.
+        case ALLEGRO_KEY_J:
+            snake_render_pan(game->renderer, -1, 0);
+            break;
+        case ALLEGRO_KEY_L:
+            snake_render_pan(game->renderer, 1, 0);
+            break;
+        case ALLEGRO_KEY_I:
+            snake_render_pan(game->renderer, 0, -1);
+            break;
+        case ALLEGRO_KEY_K:
+            snake_render_pan(game->renderer, 0, 1);
+            break;
+        case ALLEGRO_KEY_F:
+            snake_render_follow(game->renderer);
             break;
 
         case ALLEGRO_KEY_SPACE:
@@ -249,47 +367,90 @@ static void jbutton_update(game_t * game, ALLEGRO_JOYSTICK_EVENT * e)
     }
 }
 
-static void poll_allegro(game_t * game)
+static uint32_t poll_allegro(game_t * game)
 {
     assert(game);
 
+    uint32_t ticks = 0;
     ALLEGRO_EVENT event;
-    while (al_wait_for_event_timed(game->renderer->queue, &event, 0))
+
+    /// sleep until the timer fires or something happens,
+    /// then drain everything that is queued.
+    al_wait_for_event(game->renderer->queue, &event);
+
+    do
     {
         switch (event.type)
         {
+            case ALLEGRO_EVENT_TIMER:
+                ticks++;
+                break;
+
             case ALLEGRO_EVENT_DISPLAY_CLOSE:
                 game->state = GameState_QUIT;
                 break;
 
             case ALLEGRO_EVENT_DISPLAY_RESIZE:
-                game->renderer->clip.w = event.display.width; game->renderer->clip.h = event.display.height;
-                game->renderer->scale = (game->renderer->clip.w < game->renderer->clip.h ? game->renderer->clip.w : game->renderer->clip.h) / 20;
-                game->renderer->clip.x = (game->renderer->clip.w - (game->renderer->scale * 20)) / 2;
-                game->renderer->clip.y = (game->renderer->clip.h - (game->renderer->scale * 20)) / 2;
+                snake_render_resize(game->renderer, event.display.width, event.display.height);
                 al_acknowledge_resize(event.display.source);
                 break;
 
             case ALLEGRO_EVENT_KEY_DOWN:
                 keyboard_update(game, &event.keyboard);
+                game->renderer->redraw = true;
                 break;
 
             case ALLEGRO_EVENT_JOYSTICK_BUTTON_DOWN:
                 jbutton_update(game, &event.joystick);
+                game->renderer->redraw = true;
                 break;
 
             default:
                 break;
         }
-    }
+    } while (al_get_next_event(game->renderer->queue, &event));
+
+    return ticks;
 }
 #endif
 
-void snake_poll(game_t * game)
+int snake_poll_init(game_t * game)
 {
+    assert(game); assert(game->tick_rate);
+
     #ifdef ALLEGRO
-        poll_allegro(game);
+        game->io->timer = al_create_timer(1.0 / game->tick_rate);
+        assert(game->io->timer);
+        al_register_event_source(game->renderer->queue, al_get_timer_event_source(game->io->timer));
+        al_start_timer(game->io->timer);
     #elif SDL2
-        poll_sdl2(game);
+        game->io->tick_ms = 1000 / game->tick_rate;
+        game->io->next_tick = SDL_GetTicks() + game->io->tick_ms;
     #endif
+
+    return 0;
+}
+
+void snake_poll_exit(game_t * game)
+{
+    assert(game);
+
+    #ifdef ALLEGRO
+        if (game->io->timer)
+        {
+            al_destroy_timer(game->io->timer);
+            game->io->timer = NULL;
+        }
+    #endif
+}
+
+uint32_t snake_poll(game_t * game)
+{
+    #ifdef ALLEGRO
+        return poll_allegro(game);
+    #elif SDL2
+        return poll_sdl2(game);
+    #endif
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "snake_raster.h"
+
+int framebuffer_create(framebuffer_t * fb, const uint32_t w, const uint32_t h)
+{
+    assert(fb); assert(w); assert(h);
+
+    memset(fb, 0, sizeof(framebuffer_t));
+
+    /// rows start 64 byte aligned, so full spans never split a cache line.
+    const uint32_t pitch = (w + 15) & ~15u;
+
+    fb->pixels = aligned_alloc(64, (size_t)pitch * h * sizeof(uint32_t));
+    if (!fb->pixels)
+    {
+        return -1;
+    }
+
+    fb->w = w;
+    fb->h = h;
+    fb->pitch = pitch;
+    fb->owned = true;
+
+    return 0;
+}
+
+void framebuffer_wrap(framebuffer_t * fb, uint32_t * pixels, const uint32_t w, const uint32_t h, const uint32_t pitch)
+{
+    assert(fb); assert(pixels); assert(pitch >= w);
+
+    fb->pixels = pixels;
+    fb->w = w;
+    fb->h = h;
+    fb->pitch = pitch;
+    fb->owned = false;
+}
+
+void framebuffer_free(framebuffer_t * fb)
+{
+    assert(fb);
+
+    if (fb->owned && fb->pixels)
+    {
+        free(fb->pixels);
+    }
+
+    memset(fb, 0, sizeof(framebuffer_t));
+}
+
+void raster_fill_rect(framebuffer_t * fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint32_t colour)
+{
+    assert(fb);
+
+    if (x >= fb->w || y >= fb->h)
+    {
+        return;
+    }
+
+    if (w > fb->w - x) w = fb->w - x;
+    if (h > fb->h - y) h = fb->h - y;
+
+    uint32_t *row = &fb->pixels[(size_t)y * fb->pitch + x];
+
+    for (uint32_t i = 0; i < h; i++, row += fb->pitch)
+    {
+        raster_fill_span(row, w, colour);
+    }
+}
+
+void raster_clear(framebuffer_t * fb, const uint32_t colour)
+{
+    assert(fb);
+
+    raster_fill_rect(fb, 0, 0, fb->w, fb->h, colour);
+}
+
+void raster_palette_default(uint32_t palette[256])
+{
+    assert(palette);
+
+    memset(palette, 0, 256 * sizeof(uint32_t));
+
+    palette[BoardCellType_EMPTY]        = raster_rgba(0, 0, 0, 255);
+    palette[BoardCellType_WALL]         = raster_rgba(153, 0, 0, 255);
+    palette[BoardCellType_SNAKEHEAD]    = raster_rgba(56, 153, 56, 255);
+    palette[BoardCellType_SNAKEBODY]    = raster_rgba(36, 93, 36, 255);
+    palette[BoardCellType_ITEM]         = raster_rgba(56, 153, 153, 255);
+}
+
+/// start of a size long window on one axis of extent cells, kept on it.
+static inline uint16_t view_clamp(const int32_t start, const uint16_t size, const uint16_t extent)
+{
+    if (start < 0)
+    {
+        return 0;
+    }
+
+    return start > extent - size ? extent - size : start;
+}
+
+bool raster_view_fit(raster_view_t * view, const board_t * board, const uint16_t w, const uint16_t h)
+{
+    assert(view); assert(board);
+
+    const raster_view_t old = *view;
+
+    view->w = w < board->rows ? w : board->rows;
+    view->h = h < board->columns ? h : board->columns;
+    view->x = view_clamp(view->x, view->w, board->rows);
+    view->y = view_clamp(view->y, view->h, board->columns);
+
+    return memcmp(&old, view, sizeof(raster_view_t)) != 0;
+}
+
+/// re-centres one axis on pos once it is within a quarter of an edge.
+static inline uint16_t view_follow(const uint16_t start, const uint16_t size, const uint16_t extent, const uint16_t pos)
+{
+    const uint16_t margin = size / 4;
+
+    if (pos >= start + margin && pos < start + size - margin)
+    {
+        return start;
+    }
+
+    return view_clamp((int32_t)pos - size / 2, size, extent);
+}
+
+bool raster_view_follow(raster_view_t * view, const board_t * board, const uint16_t w, const uint16_t h, const uint16_t x, const uint16_t y)
+{
+    assert(view); assert(board);
+
+    bool changed = raster_view_fit(view, board, w, h);
+
+    const uint16_t vx = view_follow(view->x, view->w, board->rows, x);
+    const uint16_t vy = view_follow(view->y, view->h, board->columns, y);
+
+    changed |= vx != view->x || vy != view->y;
+    view->x = vx;
+    view->y = vy;
+
+    return changed;
+}
+
+raster_rect_t raster_board_view(framebuffer_t * fb, board_t * board, const uint32_t palette[256], const uint32_t scale, const raster_view_t * view)
+{
+    assert(fb); assert(board); assert(palette); assert(scale); assert(view);
+    assert(view->x + view->w <= board->rows && view->y + view->h <= board->columns);
+    assert(fb->w >= view->w * scale && fb->h >= view->h * scale);
+
+    raster_rect_t touched = {0};
+
+    if (board->dirty_all)
+    {
+        /// x runs along rows, so each line of cells is one scanline of
+        /// spans, copied down for the rest of the cell's height.
+        for (uint16_t c = 0; c < view->h; c++)
+        {
+            uint32_t *line = &fb->pixels[(size_t)c * scale * fb->pitch];
+
+            for (uint16_t r = 0; r < view->w; r++)
+            {
+                raster_fill_span(line + r * scale, scale, palette[board_get(board, view->x + r, view->y + c)]);
+            }
+
+            for (uint32_t i = 1; i < scale; i++)
+            {
+                memcpy(line + i * fb->pitch, line, view->w * scale * sizeof(uint32_t));
+            }
+        }
+
+        touched.w = view->w * scale;
+        touched.h = view->h * scale;
+    }
+    else if (board->dirty_count)
+    {
+        uint32_t x0 = UINT32_MAX, y0 = UINT32_MAX, x1 = 0, y1 = 0;
+
+        for (uint16_t i = 0; i < board->dirty_count; i++)
+        {
+            const uint16_t r = board->dirty[i] / board->stride - BOARD_PADDING;
+            const uint16_t c = board->dirty[i] % board->stride - BOARD_PADDING;
+
+            /// off screen cells wrap around to past the view.
+            const uint32_t vr = (uint32_t)(r - view->x);
+            const uint32_t vc = (uint32_t)(c - view->y);
+            if (vr >= view->w || vc >= view->h)
+            {
+                continue;
+            }
+
+            raster_fill_rect(fb, vr * scale, vc * scale, scale, scale, palette[board_get(board, r, c)]);
+
+            if (vr < x0) x0 = vr;
+            if (vr > x1) x1 = vr;
+            if (vc < y0) y0 = vc;
+            if (vc > y1) y1 = vc;
+        }
+
+        if (x0 != UINT32_MAX)
+        {
+            touched.x = x0 * scale;
+            touched.y = y0 * scale;
+            touched.w = (x1 - x0 + 1) * scale;
+            touched.h = (y1 - y0 + 1) * scale;
+        }
+    }
+
+    board_clear_dirty(board);
+
+    return touched;
+}
+
+raster_rect_t raster_board(framebuffer_t * fb, board_t * board, const uint32_t palette[256], const uint32_t scale)
+{
+    const raster_view_t view = { .x = 0, .y = 0, .w = board->rows, .h = board->columns };
+
+    return raster_board_view(fb, board, palette, scale, &view);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "snake_core.h"
+
+/// cpu rasterizer for the board, no gpu or window needed.
+/// pixels are ARGB8888 (bgra bytes in memory on little endian),
+/// the same layout as the SDL streaming texture, so a frame can be
+/// uploaded or written out as is.
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+typedef struct
+{
+    /// pixels[y * pitch + x].
+    uint32_t *pixels;
+    uint32_t w;
+    uint32_t h;
+    /// pixels per row.
+    uint32_t pitch;
+    /// pixels was allocated by framebuffer_create.
+    bool owned;
+} framebuffer_t;
+
+/// pixels inside the board that a raster_board call touched, w == 0 for none.
+typedef struct
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t w;
+    uint32_t h;
+} raster_rect_t;
+
+/// the cells drawn, rows x .. x + w - 1 and columns y .. y + h - 1,
+/// with cell x,y at the framebuffer's top left.
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+} raster_view_t;
+
+static inline uint32_t raster_rgba(const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a)
+{
+    return ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+/// count pixels of colour from dst, unaligned is fine.
+static inline void raster_fill_span(uint32_t * dst, uint32_t count, const uint32_t colour)
+{
+    #if defined(__AVX2__)
+        const __m256i v8 = _mm256_set1_epi32(colour);
+        for (; count >= 8; count -= 8, dst += 8)
+        {
+            _mm256_storeu_si256((__m256i *)dst, v8);
+        }
+    #endif
+
+    #if defined(__SSE2__)
+        const __m128i v4 = _mm_set1_epi32(colour);
+        for (; count >= 4; count -= 4, dst += 4)
+        {
+            _mm_storeu_si128((__m128i *)dst, v4);
+        }
+    #elif defined(__ARM_NEON)
+        const uint32x4_t v4 = vdupq_n_u32(colour);
+        for (; count >= 4; count -= 4, dst += 4)
+        {
+            vst1q_u32(dst, v4);
+        }
+    #endif
+
+    while (count--)
+    {
+        *dst++ = colour;
+    }
+}
+
+int framebuffer_create(framebuffer_t * fb, const uint32_t w, const uint32_t h);
+/// wraps memory owned by someone else, eg, a cpu copy of a texture.
+void framebuffer_wrap(framebuffer_t * fb, uint32_t * pixels, const uint32_t w, const uint32_t h, const uint32_t pitch);
+void framebuffer_free(framebuffer_t * fb);
+
+/// fills the part of the rect inside fb.
+void raster_fill_rect(framebuffer_t * fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint32_t colour);
+void raster_clear(framebuffer_t * fb, const uint32_t colour);
+
+/// colour of each BoardCellType, anything else is transparent black.
+void raster_palette_default(uint32_t palette[256]);
+
+/// makes view w x h cells (no more than the board) and moves it back
+/// onto the board if it hangs off. true if it changed.
+bool raster_view_fit(raster_view_t * view, const board_t * board, const uint16_t w, const uint16_t h);
+
+/// fits view, then keeps cell x,y (the head) a quarter of the view away
+/// from its edges by re-centring on it when it gets closer. it moves once
+/// every few cells rather than every tick, so most frames stay incremental.
+/// true if it changed.
+bool raster_view_follow(raster_view_t * view, const board_t * board, const uint16_t w, const uint16_t h, const uint16_t x, const uint16_t y);
+
+/// draws the cells in view with its top left cell at 0,0 and scale pixels
+/// per cell. only the board's dirty cells are drawn (all of the view if
+/// dirty_all), those outside the view are skipped, then the dirty list is
+/// cleared. fb must hold view w x h cells.
+raster_rect_t raster_board_view(framebuffer_t * fb, board_t * board, const uint32_t palette[256], const uint32_t scale, const raster_view_t * view);
+
+/// raster_board_view of the whole board.
+raster_rect_t raster_board(framebuffer_t * fb, board_t * board, const uint32_t palette[256], const uint32_t scale);
@@ -0,0 +1,325 @@
+#include "snake_core.h"
+
+static inline bool region_open(const board_t * board, const uint32_t i)
+{
+    return !board_blocked(board, i);
+}
+
+static inline uint32_t region_find(region_t * region, uint32_t n)
+{
+    uint32_t *link = region->link;
+
+    /// path halving, every other node on the way up skips to its grandparent.
+    for (;;)
+    {
+        const uint32_t up = link[n];
+        if (up & REGION_ROOT)
+        {
+            return n;
+        }
+
+        const uint32_t top = link[up];
+        if (top & REGION_ROOT)
+        {
+            return up;
+        }
+
+        link[n] = top;
+        n = top;
+    }
+}
+
+/// cells in the region rooted at root.
+static inline uint32_t region_size(const region_t * region, const uint32_t root)
+{
+    return region->link[root] & ~REGION_ROOT;
+}
+
+static inline void region_union(region_t * region, const uint32_t a, const uint32_t b)
+{
+    uint32_t ra = region_find(region, a);
+    uint32_t rb = region_find(region, b);
+
+    if (ra == rb)
+    {
+        return;
+    }
+
+    /// the smaller tree goes under the bigger one.
+    if (region_size(region, ra) < region_size(region, rb))
+    {
+        const uint32_t t = ra; ra = rb; rb = t;
+    }
+
+    region->link[ra] += region_size(region, rb);
+    region->link[rb] = ra;
+}
+
+static inline uint32_t region_new_node(region_t * region, const uint32_t i)
+{
+    const uint32_t n = region->node_count++;
+    region->link[n] = REGION_ROOT | 1;
+    region->node[i] = n;
+    return n;
+}
+
+/// labels every free cell from scratch, each one joined to the free cells
+/// before it (one row up and one column left), so one pass is enough.
+static void region_rebuild(board_t * board)
+{
+    region_t *region = &board->region;
+    region->node_count = 0;
+
+    for (uint16_t x = 0; x < board->rows; x++)
+    {
+        for (uint16_t y = 0; y < board->columns; y++)
+        {
+            const uint32_t i = board_bit_index(board, x, y);
+
+            if (!region_open(board, i))
+            {
+                continue;
+            }
+
+            const uint32_t n = region_new_node(region, i);
+
+            if (region_open(board, i - board->stride))
+            {
+                region_union(region, n, region->node[i - board->stride]);
+            }
+            if (region_open(board, i - 1))
+            {
+                region_union(region, n, region->node[i - 1]);
+            }
+        }
+    }
+
+    region->stale = false;
+    region->rebuilds++;
+}
+
+void board_region_free(board_t * board, const uint32_t i)
+{
+    region_t *region = &board->region;
+
+    /// out of fresh nodes, start again on the next query.
+    if (region->node_count == region->node_max)
+    {
+        region->stale = true;
+        return;
+    }
+
+    const uint32_t n = region_new_node(region, i);
+    const int32_t offset[4] = { -(int32_t)board->stride, 1, board->stride, -1 };
+
+    for (uint8_t d = 0; d < 4; d++)
+    {
+        if (region_open(board, i + offset[d]))
+        {
+            region_union(region, n, region->node[i + offset[d]]);
+        }
+    }
+}
+
+/// the search a mark belongs to, after the merges so far.
+static inline uint8_t split_root(const uint8_t * parent, uint8_t s)
+{
+    while (parent[s] != s)
+    {
+        s = parent[s];
+    }
+
+    return s;
+}
+
+/// i was just filled and its free neighbours are in more than one run
+/// around it, so its region may have been cut in two (or more). searches
+/// breadth first from a neighbour in each run at once, one queue for all of
+/// them so they grow in step. two searches that meet are still one region.
+/// once only one is left going, every search that ran out of cells before
+/// meeting another is a piece cut off, and gets a new root of its own.
+/// the work is about the size of the smaller pieces, not the board.
+static void region_split(board_t * board, const uint32_t i, const uint8_t open, const int32_t ring[8])
+{
+    region_t *region = &board->region;
+    region->splits++;
+
+    /// a new root for each cut off piece, too few left means start again.
+    if (region->node_count + 4 > region->node_max)
+    {
+        region->stale = true;
+        return;
+    }
+
+    if (!region->mark_clear)
+    {
+        memset(region->mark, 0, (size_t)(board->rows + BOARD_PADDING * 2) * board->stride);
+        region->mark_clear = true;
+    }
+
+    const int32_t offset[4] = { -(int32_t)board->stride, 1, board->stride, -1 };
+
+    uint8_t *mark = region->mark;
+    uint32_t *queue = region->queue;
+    uint32_t head = 0, tail = 0;
+
+    uint8_t parent[4];
+    uint32_t pending[4] = {0};
+    uint32_t count[4] = {0};
+    bool closed[4] = {false};
+    uint8_t searches = 0;
+
+    /// one neighbour from each run, a corner run starts at the next one.
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        const bool starts = (open >> r & 1) && !(open >> ((r + 7) & 7) & 1);
+        if (!starts || ((r & 1) && !(open >> ((r + 1) & 7) & 1)))
+        {
+            continue;
+        }
+
+        const uint32_t cell = i + ring[(r + (r & 1)) & 7];
+        parent[searches] = searches;
+        pending[searches] = 1;
+        count[searches] = 1;
+        mark[cell] = 1 + searches;
+        queue[tail++] = cell;
+        searches++;
+    }
+
+    uint8_t live = searches;
+
+    while (live > 1 && head < tail)
+    {
+        const uint32_t cell = queue[head++];
+        const uint8_t s = split_root(parent, mark[cell] - 1);
+        pending[s]--;
+
+        for (uint8_t d = 0; d < 4 && live > 1; d++)
+        {
+            const uint32_t next = cell + offset[d];
+
+            if (!region_open(board, next))
+            {
+                continue;
+            }
+
+            if (mark[next])
+            {
+                const uint8_t t = split_root(parent, mark[next] - 1);
+                if (t != s)
+                {
+                    /// met, from here on they are one search.
+                    parent[t] = s;
+                    pending[s] += pending[t];
+                    count[s] += count[t];
+                    live--;
+                }
+                continue;
+            }
+
+            mark[next] = 1 + s;
+            queue[tail++] = next;
+            pending[s]++;
+            count[s]++;
+        }
+
+        if (!pending[s] && live > 1)
+        {
+            closed[s] = true;
+            live--;
+        }
+    }
+
+    const uint32_t old_root = region_find(region, region->node[i]);
+    region->link[old_root]--;
+
+    uint32_t piece[4];
+    for (uint8_t s = 0; s < searches; s++)
+    {
+        if (closed[s] && parent[s] == s)
+        {
+            piece[s] = region->node_count++;
+            region->link[piece[s]] = REGION_ROOT | count[s];
+            region->link[old_root] -= count[s];
+        }
+    }
+
+    /// every cell of a cut off piece was searched, point them all at its
+    /// root. every cell marked is in the queue, so this clears them all.
+    for (uint32_t q = 0; q < tail; q++)
+    {
+        const uint8_t s = split_root(parent, mark[queue[q]] - 1);
+        if (closed[s])
+        {
+            region->node[queue[q]] = piece[s];
+        }
+
+        mark[queue[q]] = 0;
+    }
+}
+
+void board_region_fill(board_t * board, const uint32_t i)
+{
+    region_t *region = &board->region;
+    const int32_t stride = board->stride;
+
+    /// the 8 cells around i in order, each next to the one before it.
+    /// even entries are the 4 neighbours, odd ones the corners between.
+    const int32_t ring[8] = { -1, stride - 1, stride, stride + 1, 1, -stride + 1, -stride, -stride - 1 };
+
+    uint8_t open = 0;
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        open |= region_open(board, i + ring[r]) << r;
+    }
+
+    /// count the runs of open ring cells that hold a neighbour. one run
+    /// means every free neighbour still reaches the others without i.
+    uint8_t runs = open == 0xFF;
+
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        const bool starts = (open >> r & 1) && !(open >> ((r + 7) & 7) & 1);
+
+        /// a run from a corner holds a neighbour only if it goes on past it.
+        if (starts && (!(r & 1) || (open >> ((r + 1) & 7) & 1)))
+        {
+            runs++;
+        }
+    }
+
+    if (runs > 1)
+    {
+        region_split(board, i, open, ring);
+        return;
+    }
+
+    /// i stays in the tree (others may hang off it), its region is one smaller.
+    region->link[region_find(region, region->node[i])]--;
+}
+
+uint32_t board_region_id(board_t * board, const uint32_t i)
+{
+    assert(board);
+
+    if (!region_open(board, i))
+    {
+        return UINT32_MAX;
+    }
+
+    if (board->region.stale)
+    {
+        region_rebuild(board);
+    }
+
+    return region_find(&board->region, board->region.node[i]);
+}
+
+uint32_t board_region_size(board_t * board, const uint32_t i)
+{
+    assert(board);
+
+    const uint32_t id = board_region_id(board, i);
+    return id == UINT32_MAX ? 0 : region_size(&board->region, id);
+}
@@ -21,7 +21,8 @@ static int allegro_init(renderer_t * renderer, const uint32_t w, const uint32_t
     renderer->queue = al_create_event_queue();
     assert(renderer->queue);
 
-    renderer->font = al_load_ttf_font("data/mplus-2p-regular.ttf", 64, 0);
+    renderer->font_size = 64;
+    renderer->font = al_load_ttf_font("data/mplus-2p-regular.ttf", renderer->font_size, 0);
     assert(renderer->font);
 
     al_register_event_source(renderer->queue, al_get_display_event_source(renderer->display));
@@ -31,12 +32,25 @@ static int allegro_init(renderer_t * renderer, const uint32_t w, const uint32_t
 
     renderer->opengl = true;
     renderer->scale = 30;
+    renderer->board_mode = BoardMode_TEXELS;
+    raster_palette_default(renderer->palette);
 
     return 0;
 }
 
 static void allegro_exit(renderer_t * renderer)
 {
+    if (renderer->board_image)
+    {
+        al_destroy_bitmap(renderer->board_image);
+        renderer->board_image = NULL;
+    }
+    if (renderer->texture)
+    {
+        al_destroy_bitmap(renderer->texture);
+        renderer->texture = NULL;
+    }
+
     al_destroy_display(renderer->display);
     al_destroy_event_queue(renderer->queue);
     al_destroy_font(renderer->font);
@@ -67,13 +81,10 @@ static int sdl2_init(renderer_t * renderer, const uint32_t w, const uint32_t h)
         -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     assert(renderer->renderer);
 
-    renderer->texture = SDL_CreateTexture(renderer->renderer,
-        SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
-        w, h);
-    assert(renderer->texture);
-
     renderer->opengl = false;
     renderer->scale = 30;
+    renderer->board_mode = BoardMode_TEXELS;
+    raster_palette_default(renderer->palette);
 
     return 0;
 }
@@ -82,6 +93,11 @@ static void sdl2_exit(renderer_t * renderer)
 {
     assert(renderer);
 
+    if (renderer->board_image)
+    {
+        SDL_DestroyTexture(renderer->board_image);
+        renderer->board_image = NULL;
+    }
     if (renderer->texture)
     {
         SDL_DestroyTexture(renderer->texture);
@@ -102,6 +118,96 @@ static void sdl2_exit(renderer_t * renderer)
 }
 #endif
 
+static void text_cache_clear(text_cache_t * cache)
+{
+    assert(cache);
+
+    for (uint32_t i = 0; i < cache->count; i++)
+    {
+        #ifdef ALLEGRO
+            if (cache->entries[i].bitmap)
+            {
+                al_destroy_bitmap(cache->entries[i].bitmap);
+            }
+        #elif SDL2
+            if (cache->entries[i].texture)
+            {
+                SDL_DestroyTexture(cache->entries[i].texture);
+            }
+        #endif
+    }
+
+    memset(cache, 0, sizeof(text_cache_t));
+}
+
+/// rasterizes text into entry, anything it held before is released.
+static void text_entry_raster(const renderer_t * renderer, text_entry_t * entry)
+{
+    assert(renderer); assert(entry);
+
+    #ifdef ALLEGRO
+        if (entry->bitmap)
+        {
+            al_destroy_bitmap(entry->bitmap);
+            entry->bitmap = NULL;
+        }
+
+        entry->w = al_get_text_width(renderer->font, entry->text);
+        entry->h = al_get_font_line_height(renderer->font);
+
+        if (entry->w == 0 || entry->h == 0)
+        {
+            return;
+        }
+
+        ALLEGRO_BITMAP *target = al_get_target_bitmap();
+
+        entry->bitmap = al_create_bitmap(entry->w, entry->h);
+        assert(entry->bitmap);
+        al_set_target_bitmap(entry->bitmap);
+        al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+        al_draw_text(renderer->font, al_map_rgba(entry->colour.r, entry->colour.g, entry->colour.b, entry->colour.a), 0, 0, 0, entry->text);
+
+        al_set_target_bitmap(target);
+    #endif
+}
+
+static text_entry_t * text_cache_get(renderer_t * renderer, const char * text, const colour_t colour, const uint16_t size)
+{
+    assert(renderer); assert(text);
+
+    text_cache_t *cache = &renderer->text;
+    cache->clock++;
+
+    text_entry_t *oldest = &cache->entries[0];
+
+    for (uint32_t i = 0; i < cache->count; i++)
+    {
+        text_entry_t *entry = &cache->entries[i];
+
+        if (entry->size == size && !memcmp(&entry->colour, &colour, sizeof(colour_t)) && !strcmp(entry->text, text))
+        {
+            entry->used = cache->clock;
+            return entry;
+        }
+
+        if (entry->used < oldest->used)
+        {
+            oldest = entry;
+        }
+    }
+
+    text_entry_t *entry = cache->count < TEXT_CACHE_MAX ? &cache->entries[cache->count++] : oldest;
+
+    snprintf(entry->text, sizeof(entry->text), "%s", text);
+    entry->colour = colour;
+    entry->size = size;
+    entry->used = cache->clock;
+    text_entry_raster(renderer, entry);
+
+    return entry;
+}
+
 int snake_render_init(renderer_t * renderer, const uint32_t w, const uint32_t h)
 {
     #ifdef ALLEGRO
@@ -113,8 +219,67 @@ int snake_render_init(renderer_t * renderer, const uint32_t w, const uint32_t h)
     return -1;
 }
 
+static void batch_free(cell_batch_t * batch)
+{
+    assert(batch);
+
+    free(batch->rects);
+    free(batch->colours);
+    #ifdef ALLEGRO
+        free(batch->vertices);
+    #elif SDL2
+        free(batch->sorted);
+    #endif
+
+    memset(batch, 0, sizeof(cell_batch_t));
+}
+
+void snake_render_resize(renderer_t * renderer, const uint32_t w, const uint32_t h)
+{
+    assert(renderer);
+
+    renderer->clip.w = w;
+    renderer->clip.h = h;
+    renderer->board_redraw = true;
+    renderer->redraw = true;
+}
+
+void snake_render_pan(renderer_t * renderer, const int8_t dx, const int8_t dy)
+{
+    assert(renderer);
+
+    const int32_t x = renderer->view.x + dx * (renderer->view.w / 4 ? renderer->view.w / 4 : 1);
+    const int32_t y = renderer->view.y + dy * (renderer->view.h / 4 ? renderer->view.h / 4 : 1);
+
+    /// kept on the board by the next board_layout.
+    renderer->view.x = x > 0 ? (x < UINT16_MAX ? x : UINT16_MAX) : 0;
+    renderer->view.y = y > 0 ? (y < UINT16_MAX ? y : UINT16_MAX) : 0;
+    renderer->view_panned = true;
+    renderer->board_redraw = true;
+    renderer->redraw = true;
+}
+
+void snake_render_follow(renderer_t * renderer)
+{
+    assert(renderer);
+
+    renderer->view_panned = false;
+    renderer->redraw = true;
+}
+
 void snake_render_exit(renderer_t * renderer)
 {
+    batch_free(&renderer->batch);
+    text_cache_clear(&renderer->text);
+
+    free(renderer->texels);
+    renderer->texels = NULL;
+
+    #ifdef SDL2
+        free(renderer->readback);
+        renderer->readback = NULL;
+    #endif
+
     #ifdef ALLEGRO
         allegro_exit(renderer);
     #elif SDL2
@@ -132,6 +297,48 @@ static void render_clear(const renderer_t * renderer, const colour_t colour)
     #endif
 }
 
+/// reads the frame back before it is presented and queues it,
+/// the disk is only ever touched by the capture thread.
+static void render_capture(renderer_t * renderer)
+{
+    assert(renderer);
+
+    if (!renderer->capture || !capture_reserve(renderer->capture))
+    {
+        return;
+    }
+
+    capture_t *capture = renderer->capture;
+
+    #ifdef ALLEGRO
+        ALLEGRO_BITMAP *backbuffer = al_get_backbuffer(renderer->display);
+        ALLEGRO_LOCKED_REGION *region = al_lock_bitmap(backbuffer, ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_LOCK_READONLY);
+        if (region)
+        {
+            capture_push(capture, region->data, renderer->clip.w, renderer->clip.h, region->pitch);
+            al_unlock_bitmap(backbuffer);
+        }
+    #elif SDL2
+        if (!renderer->readback)
+        {
+            renderer->readback = malloc((size_t)capture->w * capture->h * sizeof(uint32_t));
+            assert(renderer->readback);
+        }
+
+        const SDL_Rect rect =
+        {
+            .x = 0, .y = 0,
+            .w = renderer->clip.w < capture->w ? renderer->clip.w : capture->w,
+            .h = renderer->clip.h < capture->h ? renderer->clip.h : capture->h,
+        };
+
+        if (SDL_RenderReadPixels(renderer->renderer, &rect, SDL_PIXELFORMAT_ARGB8888, renderer->readback, capture->w * sizeof(uint32_t)) == 0)
+        {
+            capture_push(capture, renderer->readback, rect.w, rect.h, capture->w * sizeof(uint32_t));
+        }
+    #endif
+}
+
 static void render_update(const renderer_t * renderer)
 {
     #ifdef ALLEGRO
@@ -173,10 +380,30 @@ static void draw_filled_rect(const renderer_t * renderer, const rect_t rect, con
     #endif
 }
 
-static void draw_text(const renderer_t * renderer, const colour_t colour, float x, float y, int flags, char const * text, ...)
+static void draw_text(renderer_t * renderer, const colour_t colour, float x, float y, int flags, char const * text, ...)
 {
+    assert(renderer); assert(text);
+
+    char buffer[TEXT_CACHE_LEN];
+
+    va_list args;
+    va_start(args, text);
+    vsnprintf(buffer, sizeof(buffer), text, args);
+    va_end(args);
+
+    const text_entry_t *entry = text_cache_get(renderer, buffer, colour, renderer->font_size);
+
+    /// 1 is ALLEGRO_ALIGN_CENTER.
+    if (flags & 1)
+    {
+        x -= entry->w / 2.0f;
+    }
+
     #ifdef ALLEGRO
-        al_draw_text(renderer->font, al_map_rgba(colour.r, colour.g, colour.b, colour.a), x, y, flags, text);
+        if (entry->bitmap)
+        {
+            al_draw_bitmap(entry->bitmap, x, y, 0);
+        }
     #endif
 }
 
@@ -202,64 +429,525 @@ static void draw_grid(const renderer_t * renderer, const uint32_t rows, const ui
     }
 }
 
-static void draw_board_rect(const renderer_t * renderer, const rect_t rect, BoardCellType type)
+typedef enum
 {
-    assert(renderer);
+    CellColour_NONE,
+    CellColour_EMPTY,
+    CellColour_WALL,
+    CellColour_SNAKEHEAD,
+    CellColour_SNAKEBODY,
+    CellColour_ITEM,
+    CellColour_MAX,
+} CellColour;
+
+/// the colour each cell type is drawn in, anything else is not drawn.
+static const uint8_t cell_colour_index[256] =
+{
+    [BoardCellType_EMPTY]       = CellColour_EMPTY,
+    [BoardCellType_WALL]        = CellColour_WALL,
+    [BoardCellType_SNAKEHEAD]   = CellColour_SNAKEHEAD,
+    [BoardCellType_SNAKEBODY]   = CellColour_SNAKEBODY,
+    [BoardCellType_ITEM]        = CellColour_ITEM,
+};
+
+static const colour_t cell_colours[CellColour_MAX] =
+{
+    [CellColour_EMPTY]      = { 0, 0, 0, 255 },
+    [CellColour_WALL]       = { 153, 0, 0, 255 },
+    [CellColour_SNAKEHEAD]  = { 56, 153, 56, 255 },
+    [CellColour_SNAKEBODY]  = { 36, 93, 36, 255 },
+    [CellColour_ITEM]       = { 56, 153, 153, 255 },
+};
+
+static void batch_reserve(cell_batch_t * batch, const uint32_t count)
+{
+    assert(batch);
 
-    switch (type)
+    if (count <= batch->capacity)
     {
-        case BoardCellType_EMPTY:       draw_filled_rect(renderer, rect, map_rgb(0, 0, 0));      break;
-        case BoardCellType_WALL:        draw_filled_rect(renderer, rect, map_rgb(153, 0, 0));    break;
-        case BoardCellType_SNAKEHEAD:   draw_filled_rect(renderer, rect, map_rgb(56, 153, 56));  break;
-        case BoardCellType_SNAKEBODY:   draw_filled_rect(renderer, rect, map_rgb(36, 93, 36));   break;
-        case BoardCellType_ITEM:        draw_filled_rect(renderer, rect, map_rgb(56, 153, 153)); break;
+        return;
+    }
 
-        default: break;
+    uint32_t capacity = batch->capacity ? batch->capacity : 64;
+    while (capacity < count)
+    {
+        capacity *= 2;
     }
+
+    batch->rects = realloc(batch->rects, capacity * sizeof(rect_t));
+    batch->colours = realloc(batch->colours, capacity * sizeof(uint8_t));
+    assert(batch->rects); assert(batch->colours);
+
+    #ifdef ALLEGRO
+        batch->vertices = realloc(batch->vertices, capacity * 6 * sizeof(ALLEGRO_VERTEX));
+        assert(batch->vertices);
+    #elif SDL2
+        batch->sorted = realloc(batch->sorted, capacity * sizeof(SDL_Rect));
+        assert(batch->sorted);
+    #endif
+
+    batch->capacity = capacity;
+}
+
+static void batch_cell(cell_batch_t * batch, const rect_t rect, const BoardCellType type)
+{
+    assert(batch);
+
+    const uint8_t colour = cell_colour_index[type];
+    if (colour == CellColour_NONE)
+    {
+        return;
+    }
+
+    batch_reserve(batch, batch->count + 1);
+    batch->rects[batch->count] = rect;
+    batch->colours[batch->count] = colour;
+    batch->count++;
+}
+
+/// draws everything queued, one al_draw_prim on allegro,
+/// one SDL_RenderFillRects per colour on sdl.
+static void batch_flush(const renderer_t * renderer, cell_batch_t * batch)
+{
+    assert(renderer); assert(batch);
+
+    if (batch->count == 0)
+    {
+        return;
+    }
+
+    /// counting sort by colour.
+    uint32_t offset[CellColour_MAX + 1] = {0};
+    for (uint32_t i = 0; i < batch->count; i++)
+    {
+        offset[batch->colours[i] + 1]++;
+    }
+    for (uint8_t c = 1; c <= CellColour_MAX; c++)
+    {
+        offset[c] += offset[c - 1];
+    }
+
+    uint32_t next[CellColour_MAX];
+    memcpy(next, offset, sizeof(next));
+
+    #ifdef ALLEGRO
+        ALLEGRO_COLOR colours[CellColour_MAX];
+        for (uint8_t c = 0; c < CellColour_MAX; c++)
+        {
+            colours[c] = al_map_rgba(cell_colours[c].r, cell_colours[c].g, cell_colours[c].b, cell_colours[c].a);
+        }
+
+        for (uint32_t i = 0; i < batch->count; i++)
+        {
+            const rect_t r = batch->rects[i];
+            const ALLEGRO_COLOR colour = colours[batch->colours[i]];
+            ALLEGRO_VERTEX *v = &batch->vertices[next[batch->colours[i]]++ * 6];
+
+            const float x0 = r.x, y0 = r.y, x1 = r.x + r.w, y1 = r.y + r.h;
+            v[0] = (ALLEGRO_VERTEX){ .x = x0, .y = y0, .color = colour };
+            v[1] = (ALLEGRO_VERTEX){ .x = x1, .y = y0, .color = colour };
+            v[2] = (ALLEGRO_VERTEX){ .x = x1, .y = y1, .color = colour };
+            v[3] = (ALLEGRO_VERTEX){ .x = x0, .y = y0, .color = colour };
+            v[4] = (ALLEGRO_VERTEX){ .x = x1, .y = y1, .color = colour };
+            v[5] = (ALLEGRO_VERTEX){ .x = x0, .y = y1, .color = colour };
+        }
+
+        al_draw_prim(batch->vertices, NULL, NULL, 0, batch->count * 6, ALLEGRO_PRIM_TRIANGLE_LIST);
+    #elif SDL2
+        for (uint32_t i = 0; i < batch->count; i++)
+        {
+            const rect_t r = batch->rects[i];
+            batch->sorted[next[batch->colours[i]]++] = (SDL_Rect){ .x = r.x, .y = r.y, .w = r.w, .h = r.h };
+        }
+
+        for (uint8_t c = 0; c < CellColour_MAX; c++)
+        {
+            const uint32_t count = offset[c + 1] - offset[c];
+            if (count)
+            {
+                SDL_SetRenderDrawColor(renderer->renderer, cell_colours[c].r, cell_colours[c].g, cell_colours[c].b, cell_colours[c].a);
+                SDL_RenderFillRects(renderer->renderer, &batch->sorted[offset[c]], count);
+            }
+        }
+    #endif
+
+    batch->count = 0;
 }
 
-static void draw_board(const renderer_t * renderer, const board_t * board)
+/// (re)creates the board image if the board or scale changed size.
+/// returns true if the image is new and has nothing drawn in it.
+static bool board_image_create(renderer_t * renderer, const uint32_t w, const uint32_t h)
+{
+    assert(renderer); assert(w); assert(h);
+
+    if (renderer->board_image && renderer->board_w == w && renderer->board_h == h)
+    {
+        return false;
+    }
+
+    #ifdef ALLEGRO
+        if (renderer->board_image)
+        {
+            al_destroy_bitmap(renderer->board_image);
+        }
+        renderer->board_image = al_create_bitmap(w, h);
+    #elif SDL2
+        if (renderer->board_image)
+        {
+            SDL_DestroyTexture(renderer->board_image);
+        }
+        renderer->board_image = SDL_CreateTexture(renderer->renderer,
+            SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+            w, h);
+    #endif
+
+    assert(renderer->board_image);
+    renderer->board_w = w;
+    renderer->board_h = h;
+
+    return true;
+}
+
+/// draw calls between begin / end go into the board image.
+static void board_image_begin(const renderer_t * renderer)
+{
+    #ifdef ALLEGRO
+        al_set_target_bitmap(renderer->board_image);
+    #elif SDL2
+        SDL_SetRenderTarget(renderer->renderer, renderer->board_image);
+    #endif
+}
+
+static void board_image_end(const renderer_t * renderer)
+{
+    #ifdef ALLEGRO
+        al_set_target_bitmap(al_get_backbuffer(renderer->display));
+    #elif SDL2
+        SDL_SetRenderTarget(renderer->renderer, NULL);
+    #endif
+}
+
+static void draw_board_image(const renderer_t * renderer)
+{
+    #ifdef ALLEGRO
+        al_draw_bitmap(renderer->board_image, renderer->clip.x, renderer->clip.y, 0);
+    #elif SDL2
+        const SDL_Rect dst = { .x = renderer->clip.x, .y = renderer->clip.y, .w = renderer->board_w, .h = renderer->board_h };
+        SDL_RenderCopy(renderer->renderer, renderer->board_image, NULL, &dst);
+    #endif
+}
+
+static void draw_board_rects(renderer_t * renderer, board_t * board)
 {
     assert(renderer); assert(board);
 
-    for (uint8_t r = 0; r < board->rows; r++)
+    const uint32_t scale = renderer->scale;
+    const raster_view_t view = renderer->view;
+
+    if (board_image_create(renderer, view.w * scale, view.h * scale) || renderer->board_redraw)
+    {
+        board->dirty_all = true;
+        renderer->board_redraw = false;
+    }
+
+    board_image_begin(renderer);
+
+    if (board->dirty_all)
     {
-        for (uint8_t c = 0; c < board->columns; c++)
+        render_clear(renderer, map_rgb(0, 0, 0));
+
+        for (uint16_t r = 0; r < view.w; r++)
         {
-            if (board->board[r][c] == BoardCellType_EMPTY)
+            for (uint16_t c = 0; c < view.h; c++)
+            {
+                const uint8_t cell = board_get(board, view.x + r, view.y + c);
+
+                if (cell == BoardCellType_EMPTY)
+                {
+                    continue;
+                }
+
+                batch_cell(&renderer->batch, map_rect(r * scale, c * scale, scale, scale), cell);
+            }
+        }
+    }
+    else
+    {
+        /// empty cells are drawn too, they may have just been vacated.
+        for (uint16_t i = 0; i < board->dirty_count; i++)
+        {
+            const uint16_t r = board->dirty[i] / board->stride - BOARD_PADDING;
+            const uint16_t c = board->dirty[i] % board->stride - BOARD_PADDING;
+
+            /// culled before it is batched, off screen wraps past the view.
+            const uint32_t vr = (uint32_t)(r - view.x);
+            const uint32_t vc = (uint32_t)(c - view.y);
+            if (vr >= view.w || vc >= view.h)
             {
                 continue;
             }
 
-            draw_board_rect(renderer,
-                map_rect(renderer->clip.x + (r * renderer->scale), renderer->clip.y + (c * renderer->scale), renderer->scale, renderer->scale),
-                board->board[r][c]);
+            batch_cell(&renderer->batch, map_rect(vr * scale, vc * scale, scale, scale), board_get(board, r, c));
         }
     }
+
+    batch_flush(renderer, &renderer->batch);
+
+    board_image_end(renderer);
+    board_clear_dirty(board);
+
+    draw_board_image(renderer);
 }
 
-static void draw_osd(const renderer_t * renderer, const board_t * board)
+/// (re)creates the texel texture and its cpu copy if the board changed size.
+/// returns true if the texture is new and has nothing in it.
+static bool texture_create(renderer_t * renderer, const uint32_t w, const uint32_t h)
+{
+    assert(renderer); assert(w); assert(h);
+
+    if (renderer->texture && renderer->texels_w == w && renderer->texels_h == h)
+    {
+        return false;
+    }
+
+    #ifdef ALLEGRO
+        if (renderer->texture)
+        {
+            al_destroy_bitmap(renderer->texture);
+        }
+        /// no linear flags, so the upscale is nearest.
+        al_set_new_bitmap_flags(ALLEGRO_VIDEO_BITMAP);
+        renderer->texture = al_create_bitmap(w, h);
+    #elif SDL2
+        if (renderer->texture)
+        {
+            SDL_DestroyTexture(renderer->texture);
+        }
+        renderer->texture = SDL_CreateTexture(renderer->renderer,
+            SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+            w, h);
+        SDL_SetTextureScaleMode(renderer->texture, SDL_ScaleModeNearest);
+    #endif
+
+    assert(renderer->texture);
+
+    renderer->texels = realloc(renderer->texels, w * h * sizeof(uint32_t));
+    assert(renderer->texels);
+    renderer->texels_w = w;
+    renderer->texels_h = h;
+
+    return true;
+}
+
+/// copies texels inside x0,y0 - x1,y1 (inclusive) to the texture.
+static void texture_upload(const renderer_t * renderer, const uint32_t x0, const uint32_t y0, const uint32_t x1, const uint32_t y1)
+{
+    assert(renderer);
+
+    const uint32_t w = x1 - x0 + 1;
+    const uint32_t h = y1 - y0 + 1;
+    const uint32_t *src = &renderer->texels[y0 * renderer->texels_w + x0];
+
+    #ifdef ALLEGRO
+        ALLEGRO_LOCKED_REGION *region = al_lock_bitmap_region(renderer->texture,
+            x0, y0, w, h, ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_LOCK_WRITEONLY);
+        assert(region);
+
+        /// pitch can be negative (bottom up opengl textures).
+        for (uint32_t y = 0; y < h; y++)
+        {
+            memcpy((uint8_t *)region->data + (intptr_t)y * region->pitch, src + y * renderer->texels_w, w * sizeof(uint32_t));
+        }
+
+        al_unlock_bitmap(renderer->texture);
+    #elif SDL2
+        const SDL_Rect rect = { .x = x0, .y = y0, .w = w, .h = h };
+        SDL_UpdateTexture(renderer->texture, &rect, src, renderer->texels_w * sizeof(uint32_t));
+    #endif
+}
+
+/// the whole texture, stretched (nearest) to w x h at the board's corner.
+static void draw_texture(const renderer_t * renderer, const uint32_t w, const uint32_t h)
+{
+    assert(renderer);
+
+    #ifdef ALLEGRO
+        al_draw_scaled_bitmap(renderer->texture, 0, 0, renderer->texels_w, renderer->texels_h, renderer->clip.x, renderer->clip.y, w, h, 0);
+    #elif SDL2
+        const SDL_Rect dst = { .x = renderer->clip.x, .y = renderer->clip.y, .w = w, .h = h };
+        SDL_RenderCopy(renderer->renderer, renderer->texture, NULL, &dst);
+    #endif
+}
+
+static void draw_board_texels(renderer_t * renderer, board_t * board)
+{
+    assert(renderer); assert(board);
+
+    const raster_view_t view = renderer->view;
+
+    if (texture_create(renderer, view.w, view.h) || renderer->board_redraw)
+    {
+        board->dirty_all = true;
+        renderer->board_redraw = false;
+    }
+
+    if (board->dirty_all)
+    {
+        for (uint16_t r = 0; r < view.w; r++)
+        {
+            for (uint16_t c = 0; c < view.h; c++)
+            {
+                renderer->texels[c * renderer->texels_w + r] = renderer->palette[board_get(board, view.x + r, view.y + c)];
+            }
+        }
+
+        texture_upload(renderer, 0, 0, view.w - 1, view.h - 1);
+    }
+    else if (board->dirty_count)
+    {
+        /// one upload covering every changed texel on screen.
+        uint32_t x0 = UINT32_MAX, y0 = UINT32_MAX, x1 = 0, y1 = 0;
+
+        for (uint16_t i = 0; i < board->dirty_count; i++)
+        {
+            const uint16_t r = board->dirty[i] / board->stride - BOARD_PADDING;
+            const uint16_t c = board->dirty[i] % board->stride - BOARD_PADDING;
+
+            const uint32_t vr = (uint32_t)(r - view.x);
+            const uint32_t vc = (uint32_t)(c - view.y);
+            if (vr >= view.w || vc >= view.h)
+            {
+                continue;
+            }
+
+            renderer->texels[vc * renderer->texels_w + vr] = renderer->palette[board_get(board, r, c)];
+
+            if (vr < x0) x0 = vr;
+            if (vr > x1) x1 = vr;
+            if (vc < y0) y0 = vc;
+            if (vc > y1) y1 = vc;
+        }
+
+        if (x0 != UINT32_MAX)
+        {
+            texture_upload(renderer, x0, y0, x1, y1);
+        }
+    }
+
+    board_clear_dirty(board);
+
+    draw_texture(renderer, view.w * (uint32_t)renderer->scale, view.h * (uint32_t)renderer->scale);
+}
+
+static void draw_board_software(renderer_t * renderer, board_t * board)
 {
     assert(renderer); assert(board);
 
-    draw_text(renderer, map_rgb(80,80,80), renderer->clip.w / 2, 1 * renderer->scale, 1 /*ALLEGRO_ALIGN_CENTER*/, "Snake");
+    const uint32_t scale = renderer->scale;
+    const uint32_t w = renderer->view.w * scale;
+    const uint32_t h = renderer->view.h * scale;
+
+    if (texture_create(renderer, w, h) || renderer->board_redraw)
+    {
+        board->dirty_all = true;
+        renderer->board_redraw = false;
+    }
+
+    framebuffer_t fb;
+    framebuffer_wrap(&fb, renderer->texels, w, h, renderer->texels_w);
+
+    const raster_rect_t touched = raster_board_view(&fb, board, renderer->palette, scale, &renderer->view);
+    if (touched.w)
+    {
+        texture_upload(renderer, touched.x, touched.y, touched.x + touched.w - 1, touched.y + touched.h - 1);
+    }
+
+    draw_texture(renderer, w, h);
+}
+
+/// fits the board to the window, whole pixels per cell, centred. a board
+/// that would need less than RENDER_SCALE_MIN gets a view of the cells
+/// that fit, following the head (or where it was panned to).
+static void board_layout(renderer_t * renderer, const board_t * board, const snake_t * snake)
+{
+    assert(renderer); assert(board); assert(snake);
+
+    const uint32_t x_scale = renderer->clip.w / board->rows;
+    const uint32_t y_scale = renderer->clip.h / board->columns;
+    uint32_t scale = x_scale < y_scale ? x_scale : y_scale;
+    if (scale < RENDER_SCALE_MIN)
+    {
+        scale = RENDER_SCALE_MIN;
+    }
+
+    /// at least a cell, however small the window.
+    const uint32_t w = renderer->clip.w / scale ? renderer->clip.w / scale : 1;
+    const uint32_t h = renderer->clip.h / scale ? renderer->clip.h / scale : 1;
+    const uint16_t view_w = w < UINT16_MAX ? w : UINT16_MAX;
+    const uint16_t view_h = h < UINT16_MAX ? h : UINT16_MAX;
+
+    bool moved;
+    if (renderer->view_panned || snake->size == 0)
+    {
+        moved = raster_view_fit(&renderer->view, board, view_w, view_h);
+    }
+    else
+    {
+        const snake_body_t head = snake->body[snake->h_pos];
+        moved = raster_view_follow(&renderer->view, board, view_w, view_h, head.x, head.y);
+    }
+
+    if (moved)
+    {
+        renderer->board_redraw = true;
+    }
+
+    const uint32_t view_px = renderer->view.w * scale;
+    const uint32_t view_py = renderer->view.h * scale;
+
+    renderer->scale = scale;
+    renderer->clip.x = renderer->clip.w > view_px ? (renderer->clip.w - view_px) / 2 : 0;
+    renderer->clip.y = renderer->clip.h > view_py ? (renderer->clip.h - view_py) / 2 : 0;
+}
+
+static void draw_board(renderer_t * renderer, board_t * board, const snake_t * snake)
+{
+    assert(renderer); assert(board); assert(snake);
+
+    board_layout(renderer, board, snake);
+
+    switch (renderer->board_mode)
+    {
+        case BoardMode_RECTS:       draw_board_rects(renderer, board);      break;
+        case BoardMode_TEXELS:      draw_board_texels(renderer, board);     break;
+        case BoardMode_SOFTWARE:    draw_board_software(renderer, board);   break;
+
+        default: break;
+    }
+}
+
+static void draw_osd(renderer_t * renderer, const board_t * board)
+{
+    assert(renderer); assert(board);
+
+    draw_text(renderer, map_rgb(80,80,80), renderer->clip.w / 2, 1 * RENDER_UI_SCALE, 1 /*ALLEGRO_ALIGN_CENTER*/, "Snake");
     ///draw_grid(game->renderer, game->board->rows, game->board->columns, game->renderer->clip, map_rgb(255,255,255));
 }
 
-static void draw_menu(const renderer_t * renderer)
+static void draw_menu(renderer_t * renderer)
 {
     assert(renderer);
 
-    draw_text(renderer, map_rgb(155,155,155), renderer->clip.w / 2, 1.5 * renderer->scale, 1 /*ALLEGRO_ALIGN_CENTER*/, "Snake");
+    draw_text(renderer, map_rgb(155,155,155), renderer->clip.w / 2, 1.5 * RENDER_UI_SCALE, 1 /*ALLEGRO_ALIGN_CENTER*/, "Snake");
 
     const char * options[] = { "Play", "Options", "Quit" };
 
     for (uint8_t i = 0; i < 3; i++)
     {
         draw_filled_rect(renderer, \
-            map_rect((renderer->clip.w / 2) - (5 * renderer->scale), ((i * 3.5 + 7.8) * renderer->scale), (5 * renderer->scale) * 2, 80), \
+            map_rect((renderer->clip.w / 2) - (5 * RENDER_UI_SCALE), ((i * 3.5 + 7.8) * RENDER_UI_SCALE), (5 * RENDER_UI_SCALE) * 2, 80), \
             map_rgba(40,40,40,100));
-        draw_text(renderer, map_rgb(155,155,155), renderer->clip.w / 2, ((i * 3.5 + 7.5) * renderer->scale), 1, options[i]);
+        draw_text(renderer, map_rgb(155,155,155), renderer->clip.w / 2, ((i * 3.5 + 7.5) * RENDER_UI_SCALE), 1, options[i]);
     } 
 }
 
@@ -273,12 +961,12 @@ void snake_render(game_t * game)
     {
         
         case GameState_PLAY: case GameState_PAUSE:
-            draw_board(game->renderer, game->board);
+            draw_board(game->renderer, game->board, game->snake);
             draw_menu(game->renderer);
             break;
 
         case GameState_MENU:
-            draw_board(game->renderer, game->board);
+            draw_board(game->renderer, game->board, game->snake);
             draw_menu(game->renderer);
             break;
 
@@ -286,5 +974,8 @@ void snake_render(game_t * game)
             break;
     }
 
+    render_capture(game->renderer);
     render_update(game->renderer);
+
+    game->renderer->redraw = false;
 }
\ No newline at end of file
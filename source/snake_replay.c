@@ -0,0 +1,401 @@
+#include "snake_replay.h"
+
+#include <errno.h>
+
+static inline uint8_t * put_le(uint8_t * out, uint64_t value, const uint32_t bytes)
+{
+    for (uint32_t i = 0; i < bytes; i++, value >>= 8)
+    {
+        *out++ = value & 0xFF;
+    }
+
+    return out;
+}
+
+static inline uint64_t get_le(const uint8_t ** in, const uint32_t bytes)
+{
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < bytes; i++)
+    {
+        value |= (uint64_t)(*in)[i] << (i * 8);
+    }
+
+    *in += bytes;
+    return value;
+}
+
+static void replay_header_encode(const replay_header_t * header, uint8_t out[REPLAY_HEADER_SIZE])
+{
+    memcpy(out, header->magic, sizeof(header->magic));
+    uint8_t *p = out + sizeof(header->magic);
+
+    p = put_le(p, header->version, 1);
+    p = put_le(p, header->game_over, 1);
+    p = put_le(p, header->rows, 2);
+    p = put_le(p, header->columns, 2);
+    p = put_le(p, header->item_goal, 2);
+    p = put_le(p, header->size, 4);
+    p = put_le(p, header->score, 4);
+    p = put_le(p, header->seed, 8);
+    p = put_le(p, header->ticks, 8);
+
+    assert(p == out + REPLAY_HEADER_SIZE);
+}
+
+static void replay_header_decode(replay_header_t * header, const uint8_t in[REPLAY_HEADER_SIZE])
+{
+    memcpy(header->magic, in, sizeof(header->magic));
+    const uint8_t *p = in + sizeof(header->magic);
+
+    header->version = get_le(&p, 1);
+    header->game_over = get_le(&p, 1);
+    header->rows = get_le(&p, 2);
+    header->columns = get_le(&p, 2);
+    header->item_goal = get_le(&p, 2);
+    header->size = get_le(&p, 4);
+    header->score = get_le(&p, 4);
+    header->seed = get_le(&p, 8);
+    header->ticks = get_le(&p, 8);
+}
+
+static bool replay_write_block(replay_writer_t * writer, const replay_block_t * block)
+{
+    switch (block->kind)
+    {
+        case ReplayBlock_BEGIN:
+            writer->header_pos = ftell(writer->file);
+            return fwrite(block->data, 1, block->size, writer->file) == block->size;
+
+        case ReplayBlock_MOVES:
+            return fwrite(block->data, 1, block->size, writer->file) == block->size;
+
+        case ReplayBlock_END:
+        {
+            const long end = ftell(writer->file);
+            const bool ok = fseek(writer->file, writer->header_pos, SEEK_SET) == 0 && \
+                fwrite(block->data, 1, block->size, writer->file) == block->size;
+            return fseek(writer->file, end, SEEK_SET) == 0 && ok;
+        }
+    }
+
+    return false;
+}
+
+static void * replay_writer_thread(void * arg)
+{
+    replay_writer_t *writer = arg;
+
+    for (;;)
+    {
+        while (sem_wait(&writer->ready) != 0 && errno == EINTR);
+
+        const uint64_t tail = atomic_load_explicit(&writer->tail, memory_order_relaxed);
+        const uint64_t head = atomic_load_explicit(&writer->head, memory_order_acquire);
+
+        if (tail == head)
+        {
+            /// the close post, everything before it has been written.
+            if (atomic_load_explicit(&writer->closing, memory_order_acquire))
+            {
+                return NULL;
+            }
+            continue;
+        }
+
+        if (!replay_write_block(writer, &writer->blocks[tail % REPLAY_BLOCK_COUNT]))
+        {
+            atomic_fetch_add_explicit(&writer->errors, 1, memory_order_relaxed);
+        }
+
+        /// hands the block back to the game.
+        atomic_store_explicit(&writer->tail, tail + 1, memory_order_release);
+        sem_post(&writer->space);
+    }
+}
+
+int replay_writer_open(replay_writer_t * writer, const char * path)
+{
+    assert(writer); assert(path);
+
+    memset(writer, 0, sizeof(replay_writer_t));
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file)
+    {
+        return -1;
+    }
+
+    writer->blocks = malloc(REPLAY_BLOCK_COUNT * sizeof(replay_block_t));
+    assert(writer->blocks);
+
+    atomic_init(&writer->head, 0);
+    atomic_init(&writer->tail, 0);
+    atomic_init(&writer->errors, 0);
+    atomic_init(&writer->closing, false);
+    sem_init(&writer->ready, 0, 0);
+    sem_init(&writer->space, 0, REPLAY_BLOCK_COUNT);
+
+    if (pthread_create(&writer->thread, NULL, replay_writer_thread, writer) != 0)
+    {
+        sem_destroy(&writer->ready);
+        sem_destroy(&writer->space);
+        fclose(writer->file);
+        writer->file = NULL;
+        free(writer->blocks);
+        writer->blocks = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/// queues a block for the writer thread, waiting only if every block is queued.
+static void replay_writer_push(replay_writer_t * writer, const ReplayBlock kind, const void * data, const uint32_t size)
+{
+    assert(size <= REPLAY_BUFFER_SIZE);
+
+    if (sem_trywait(&writer->space) != 0)
+    {
+        writer->stalls++;
+        while (sem_wait(&writer->space) != 0 && errno == EINTR);
+    }
+
+    /// only the game moves head, so relaxed is enough for our own counter.
+    const uint64_t head = atomic_load_explicit(&writer->head, memory_order_relaxed);
+
+    replay_block_t *block = &writer->blocks[head % REPLAY_BLOCK_COUNT];
+    block->kind = kind;
+    block->size = size;
+    memcpy(block->data, data, size);
+
+    atomic_store_explicit(&writer->head, head + 1, memory_order_release);
+    sem_post(&writer->ready);
+}
+
+static void replay_writer_push_header(replay_writer_t * writer, const ReplayBlock kind)
+{
+    uint8_t bytes[REPLAY_HEADER_SIZE];
+    replay_header_encode(&writer->header, bytes);
+    replay_writer_push(writer, kind, bytes, sizeof(bytes));
+}
+
+static void replay_writer_flush(replay_writer_t * writer)
+{
+    const size_t bytes = (writer->used + 3) / 4;
+
+    if (bytes)
+    {
+        replay_writer_push(writer, ReplayBlock_MOVES, writer->buffer, bytes);
+        memset(writer->buffer, 0, bytes);
+    }
+
+    writer->used = 0;
+}
+
+void replay_writer_begin(replay_writer_t * writer, const game_t * game)
+{
+    assert(writer); assert(game); assert(!writer->active);
+
+    memset(&writer->header, 0, sizeof(replay_header_t));
+    memcpy(writer->header.magic, REPLAY_MAGIC, sizeof(writer->header.magic));
+    writer->header.version = REPLAY_VERSION;
+    writer->header.rows = game->board->rows;
+    writer->header.columns = game->board->columns;
+    writer->header.item_goal = game->item_goal;
+    writer->header.seed = game->seed;
+
+    /// written now to hold the space, finished in replay_writer_end.
+    replay_writer_push_header(writer, ReplayBlock_BEGIN);
+
+    writer->used = 0;
+    memset(writer->buffer, 0, sizeof(writer->buffer));
+    writer->active = true;
+}
+
+void replay_writer_move(replay_writer_t * writer, const SnakeDirection direction)
+{
+    assert(writer);
+
+    if (!writer->active)
+    {
+        return;
+    }
+
+    writer->buffer[writer->used >> 2] |= (direction & 3) << ((writer->used & 3) * 2);
+    writer->header.ticks++;
+
+    if (++writer->used == REPLAY_BUFFER_SIZE * 4)
+    {
+        replay_writer_flush(writer);
+    }
+}
+
+static void replay_writer_finish(replay_writer_t * writer)
+{
+    replay_writer_flush(writer);
+    replay_writer_push_header(writer, ReplayBlock_END);
+
+    writer->active = false;
+}
+
+void replay_writer_end(replay_writer_t * writer, const game_t * game)
+{
+    assert(writer); assert(game);
+
+    if (!writer->active)
+    {
+        return;
+    }
+
+    writer->header.game_over = game->game_over;
+    writer->header.size = game->snake->size;
+    writer->header.score = game->board->score;
+
+    replay_writer_finish(writer);
+}
+
+int replay_writer_close(replay_writer_t * writer)
+{
+    assert(writer);
+
+    if (!writer->file)
+    {
+        return 0;
+    }
+
+    /// a record left open keeps its moves, but has no outcome to check.
+    if (writer->active)
+    {
+        replay_writer_finish(writer);
+    }
+
+    atomic_store_explicit(&writer->closing, true, memory_order_release);
+    sem_post(&writer->ready);
+    pthread_join(writer->thread, NULL);
+    sem_destroy(&writer->ready);
+    sem_destroy(&writer->space);
+
+    const bool ok = fclose(writer->file) == 0 && atomic_load(&writer->errors) == 0;
+    writer->file = NULL;
+
+    free(writer->blocks);
+    writer->blocks = NULL;
+
+    return ok ? 0 : -1;
+}
+
+int replay_file_load(replay_file_t * file, const char * path)
+{
+    assert(file); assert(path);
+
+    memset(file, 0, sizeof(replay_file_t));
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    if (size <= 0)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    file->data = malloc(size);
+    assert(file->data);
+
+    file->size = fread(file->data, 1, size, f);
+    fclose(f);
+
+    return file->size == (size_t)size ? 0 : -1;
+}
+
+int replay_file_next(replay_file_t * file, replay_t * replay)
+{
+    assert(file); assert(replay);
+
+    if (file->pos == file->size)
+    {
+        return 0;
+    }
+
+    if (file->pos + REPLAY_HEADER_SIZE > file->size)
+    {
+        return -1;
+    }
+
+    replay_header_decode(&replay->header, file->data + file->pos);
+
+    if (memcmp(replay->header.magic, REPLAY_MAGIC, sizeof(replay->header.magic)) != 0 || \
+        replay->header.version != REPLAY_VERSION)
+    {
+        return -1;
+    }
+
+    const size_t bytes = (replay->header.ticks + 3) / 4;
+    if (file->pos + REPLAY_HEADER_SIZE + bytes > file->size)
+    {
+        return -1;
+    }
+
+    replay->moves = file->data + file->pos + REPLAY_HEADER_SIZE;
+    replay->tick = 0;
+    file->pos += REPLAY_HEADER_SIZE + bytes;
+
+    return 1;
+}
+
+void replay_file_free(replay_file_t * file)
+{
+    assert(file);
+
+    if (file->data)
+    {
+        free(file->data);
+        file->data = NULL;
+    }
+
+    file->size = 0;
+    file->pos = 0;
+}
+
+bool snake_replay_play(game_t * game, replay_t * replay)
+{
+    assert(game); assert(replay);
+
+    game->rows = replay->header.rows;
+    game->columns = replay->header.columns;
+    game->item_goal = replay->header.item_goal;
+
+    if (snake_new_game(game, replay->header.seed))
+    {
+        return false;
+    }
+    game->state = GameState_PLAY;
+    game->player_type = Player_REPLAY;
+    game->replay = replay;
+    replay->tick = 0;
+
+    while (replay->tick < replay->header.ticks && !game->game_over)
+    {
+        snake_step(game);
+    }
+
+    /// a snake that filled the board ends on the next step, without a move.
+    if (!game->game_over && game->board->item_count == 0 && game->board->free_count == 0)
+    {
+        snake_step(game);
+    }
+
+    game->replay = NULL;
+
+    return replay->tick == replay->header.ticks && \
+        game->game_over == replay->header.game_over && \
+        game->snake->size == replay->header.size && \
+        game->board->score == replay->header.score;
+}
\ No newline at end of file
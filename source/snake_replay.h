@@ -0,0 +1,139 @@
+#pragma once
+
+#include "snake_core.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+/// a replay is the seed and board settings of a game, followed by
+/// every move it made packed at 2 bits (a SnakeDirection) per tick,
+/// lowest bits first. replaying the moves through the core gives back
+/// the exact same game, so the recorded outcome doubles as a check.
+/// files are a plain run of records, so a corpus is many games
+/// appended together. the header is REPLAY_HEADER_SIZE bytes in the
+/// field order below, little endian whatever the host.
+///
+/// the game only packs moves. whole blocks go through a ring to a writer
+/// thread, which does every fwrite and the seek back to finish a header.
+/// the game waits only if the disk falls REPLAY_BLOCK_COUNT blocks behind,
+/// moves can't be dropped the way capture drops frames.
+
+#define REPLAY_MAGIC "SNKR"
+/// 2: the tail no longer leaves its cell empty on the tick the snake eats.
+/// 3: 16 bit board sizes, header fields packed little endian with no padding.
+#define REPLAY_VERSION 3
+#define REPLAY_HEADER_SIZE 36
+#define REPLAY_BUFFER_SIZE 4096
+#define REPLAY_BLOCK_COUNT 8
+
+typedef struct
+{
+    char magic[4];
+    uint8_t version;
+    uint8_t game_over;
+    uint16_t rows;
+    uint16_t columns;
+    uint16_t item_goal;
+    uint32_t size;
+    uint32_t score;
+    uint64_t seed;
+    /// number of moves that follow.
+    uint64_t ticks;
+} replay_header_t;
+
+typedef enum
+{
+    /// a record's header, its place is kept to finish it later.
+    ReplayBlock_BEGIN,
+    ReplayBlock_MOVES,
+    /// the open record's final header, written over the one it began with.
+    ReplayBlock_END,
+} ReplayBlock;
+
+typedef struct
+{
+    ReplayBlock kind;
+    /// bytes of data used.
+    uint32_t size;
+    uint8_t data[REPLAY_BUFFER_SIZE];
+} replay_block_t;
+
+struct replay_writer
+{
+    FILE *file;
+
+    /// a record is open, its header is finished once it ends.
+    bool active;
+    replay_header_t header;
+
+    /// moves are packed here and handed to the writer a block at a time.
+    uint32_t used;
+    uint8_t buffer[REPLAY_BUFFER_SIZE];
+
+    /// blocks pushed (head) and written (tail), block = n % REPLAY_BLOCK_COUNT.
+    replay_block_t *blocks;
+    _Atomic uint64_t head;
+    _Atomic uint64_t tail;
+    /// times the game found every block queued and had to wait.
+    uint64_t stalls;
+
+    /// posted once per pushed block (and on close), the writer sleeps on it.
+    sem_t ready;
+    /// blocks free to push into, posted by the writer as it writes each
+    /// one. the game sleeps on it when every block is queued.
+    sem_t space;
+    _Atomic bool closing;
+    pthread_t thread;
+
+    /// writer side, where the open record's header is.
+    long header_pos;
+    /// blocks the writer failed to write (disk full).
+    _Atomic uint64_t errors;
+};
+
+struct replay
+{
+    replay_header_t header;
+    const uint8_t *moves;
+
+    /// next move to read.
+    uint64_t tick;
+};
+
+/// a whole corpus loaded into memory.
+typedef struct
+{
+    uint8_t *data;
+    size_t size;
+
+    /// read position of replay_file_next.
+    size_t pos;
+} replay_file_t;
+
+static inline SnakeDirection replay_next_move(replay_t * replay)
+{
+    const uint64_t t = replay->tick++;
+    return (SnakeDirection)((replay->moves[t >> 2] >> ((t & 3) * 2)) & 3);
+}
+
+/// starts the writer thread.
+int replay_writer_open(replay_writer_t * writer, const char * path);
+/// starts a record for a game that has just been created.
+void replay_writer_begin(replay_writer_t * writer, const game_t * game);
+void replay_writer_move(replay_writer_t * writer, const SnakeDirection direction);
+/// finishes the open record (if any) with the game's outcome.
+void replay_writer_end(replay_writer_t * writer, const game_t * game);
+/// writes out everything still queued and stops the writer thread.
+/// -1 if anything failed to write.
+int replay_writer_close(replay_writer_t * writer);
+
+int replay_file_load(replay_file_t * file, const char * path);
+/// reads the next record. 1 for a record, 0 at the end of the file, -1 if
+/// what follows isn't a record this build can read: bad magic, cut short,
+/// or another REPLAY_VERSION (replay->header.version says which).
+int replay_file_next(replay_file_t * file, replay_t * replay);
+void replay_file_free(replay_file_t * file);
+
+/// re-simulates a replay on game, true if the outcome matches the record.
+bool snake_replay_play(game_t * game, replay_t * replay);
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+/// pcg32, small and fast with no shared state.
+/// every game owns one, so a seed always plays out the same way
+/// no matter which thread runs it.
+typedef struct
+{
+    uint64_t state;
+    uint64_t inc;
+} rng_t;
+
+static inline uint32_t rng_next(rng_t * rng)
+{
+    const uint64_t old = rng->state;
+    rng->state = old * 6364136223846793005ULL + rng->inc;
+
+    const uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+    const uint32_t rot = old >> 59;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+/// uniform in [0, range), multiply-shift so no division.
+static inline uint32_t rng_range(rng_t * rng, const uint32_t range)
+{
+    return ((uint64_t)rng_next(rng) * range) >> 32;
+}
+
+static inline void rng_seed(rng_t * rng, const uint64_t seed)
+{
+    /// splitmix the seed so nearby seeds start far apart.
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+
+    rng->state = 0;
+    rng->inc = (seed << 1) | 1;
+    rng_next(rng);
+    rng->state += z;
+    rng_next(rng);
+}
\ No newline at end of file
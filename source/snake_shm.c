@@ -0,0 +1,346 @@
+#include "snake_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// polls before going to sleep, a handover is often only a few us away.
+#define SHM_SPIN 128
+/// a sleeper wakes this often to look at closed, a close can race its wait.
+#define SHM_WAIT_NS 50000000
+
+static inline size_t shm_align(const size_t size)
+{
+    return (size + 63) & ~(size_t)63;
+}
+
+static inline void shm_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/// not private, the other side is another process.
+static void futex_wait(_Atomic uint32_t * word, const uint32_t value)
+{
+    const struct timespec timeout = { 0, SHM_WAIT_NS };
+    syscall(SYS_futex, word, FUTEX_WAIT, value, &timeout, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t * word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/// returns once word is no longer seen, or the ring is closed.
+static void shm_wait(shm_header_t * header, _Atomic uint32_t * word, _Atomic uint32_t * waiters, const uint32_t seen)
+{
+    for (uint32_t spin = 0; spin < SHM_SPIN; spin++)
+    {
+        if (atomic_load_explicit(word, memory_order_acquire) != seen || atomic_load(&header->closed))
+        {
+            return;
+        }
+        shm_relax();
+    }
+
+    /// counted before the last look, so a store after it always sees us.
+    atomic_fetch_add(waiters, 1);
+    if (atomic_load(word) == seen && !atomic_load(&header->closed))
+    {
+        futex_wait(word, seen);
+    }
+    atomic_fetch_sub(waiters, 1);
+}
+
+static void shm_publish(_Atomic uint32_t * word, _Atomic uint32_t * waiters, const uint32_t value)
+{
+    atomic_store(word, value);
+    if (atomic_load(waiters))
+    {
+        futex_wake(word);
+    }
+}
+
+int shm_ring_create(shm_ring_t * ring, const char * name, const env_config_t * config, const uint32_t slot_count)
+{
+    assert(ring); assert(name); assert(config); assert(config->batch); assert(slot_count);
+
+    memset(ring, 0, sizeof(shm_ring_t));
+
+    if (strlen(name) >= sizeof(ring->name))
+    {
+        return -1;
+    }
+
+    const size_t batch = config->batch;
+    const size_t obs = env_obs_size(config);
+
+    shm_header_t layout = {0};
+    layout.magic = SHM_MAGIC;
+    layout.version = SHM_VERSION;
+    layout.batch = config->batch;
+    layout.rows = config->rows;
+    layout.columns = config->columns;
+    layout.planes = EnvPlane_MAX;
+    layout.slot_count = slot_count;
+    layout.slot_offset = shm_align(sizeof(shm_header_t));
+    layout.obs_offset = 0;
+    layout.reward_offset = shm_align(layout.obs_offset + obs);
+    layout.done_offset = shm_align(layout.reward_offset + batch * sizeof(float));
+    layout.truncated_offset = shm_align(layout.done_offset + batch);
+    layout.action_offset = shm_align(layout.truncated_offset + batch);
+    layout.slot_size = shm_align(layout.action_offset + batch);
+    layout.size = layout.slot_offset + layout.slot_size * slot_count;
+
+    const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (ftruncate(fd, layout.size) != 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    void *base = mmap(NULL, layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return -1;
+    }
+
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+    ring->base = base;
+    ring->size = layout.size;
+    ring->header = base;
+    ring->owner = true;
+
+    /// the object starts zeroed, so the counters are already 0. magic is
+    /// written last, a trainer that opens early sees no ring yet.
+    layout.magic = 0;
+    memcpy(ring->header, &layout, offsetof(shm_header_t, published));
+
+    env_config_t slot_config = *config;
+    slot_config.seed_step = (uint64_t)config->batch * slot_count;
+
+    ring->envs = calloc(slot_count, sizeof(env_t *));
+    assert(ring->envs);
+
+    for (uint32_t s = 0; s < slot_count; s++)
+    {
+        const env_buffers_t out =
+        {
+            .obs = shm_ring_obs(ring, s),
+            .reward = shm_ring_reward(ring, s),
+            .done = shm_ring_done(ring, s),
+            .truncated = shm_ring_truncated(ring, s),
+        };
+        ring->envs[s] = env_create(&slot_config, &out);
+
+        if (!ring->envs[s])
+        {
+            shm_ring_close(ring);
+            return -1;
+        }
+    }
+
+    atomic_thread_fence(memory_order_release);
+    ring->header->magic = SHM_MAGIC;
+
+    return 0;
+}
+
+int shm_ring_open(shm_ring_t * ring, const char * name)
+{
+    assert(ring); assert(name);
+
+    memset(ring, 0, sizeof(shm_ring_t));
+
+    if (strlen(name) >= sizeof(ring->name))
+    {
+        return -1;
+    }
+
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_header_t))
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    shm_header_t *header = base;
+    atomic_thread_fence(memory_order_acquire);
+
+    if (header->magic != SHM_MAGIC || header->version != SHM_VERSION || header->size > (uint64_t)st.st_size)
+    {
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+    ring->base = base;
+    ring->size = st.st_size;
+    ring->header = header;
+    ring->next = 0;
+    ring->slot = 0;
+
+    return 0;
+}
+
+void shm_ring_close(shm_ring_t * ring)
+{
+    assert(ring);
+
+    if (!ring->header)
+    {
+        return;
+    }
+
+    atomic_store(&ring->header->closed, 1);
+    futex_wake(&ring->header->published);
+    futex_wake(&ring->header->released);
+
+    if (ring->envs)
+    {
+        for (uint32_t s = 0; s < ring->header->slot_count; s++)
+        {
+            if (ring->envs[s])
+            {
+                env_destroy(ring->envs[s]);
+            }
+        }
+        free(ring->envs);
+        ring->envs = NULL;
+    }
+
+    munmap(ring->base, ring->size);
+    if (ring->owner)
+    {
+        shm_unlink(ring->name);
+    }
+
+    ring->header = NULL;
+    ring->base = NULL;
+}
+
+int shm_ring_reset(shm_ring_t * ring, const uint64_t seed)
+{
+    assert(ring); assert(ring->envs);
+
+    shm_header_t *header = ring->header;
+    /// nothing published yet, or the trainer's counters would be left behind.
+    assert(atomic_load(&header->published) == 0);
+
+    uint64_t *seeds = malloc(header->batch * sizeof(uint64_t));
+    assert(seeds);
+
+    for (uint32_t s = 0; s < header->slot_count; s++)
+    {
+        for (uint32_t g = 0; g < header->batch; g++)
+        {
+            seeds[g] = seed + (uint64_t)s * header->batch + g;
+        }
+        if (env_reset(ring->envs[s], seeds))
+        {
+            free(seeds);
+            return -1;
+        }
+    }
+
+    free(seeds);
+
+    ring->next = header->slot_count;
+    ring->slot = 0;
+    atomic_store(&header->released, 0);
+    shm_publish(&header->published, &header->published_waiters, ring->next);
+    return 0;
+}
+
+bool shm_ring_step(shm_ring_t * ring)
+{
+    assert(ring); assert(ring->envs);
+
+    shm_header_t *header = ring->header;
+    const uint32_t slot = ring->slot;
+    /// the slot was last published as next - slot_count, it's ours again
+    /// once the trainer has released that one.
+    const uint32_t need = ring->next - header->slot_count + 1;
+
+    for (;;)
+    {
+        const uint32_t released = atomic_load_explicit(&header->released, memory_order_acquire);
+        if ((int32_t)(released - need) >= 0)
+        {
+            break;
+        }
+
+        if (atomic_load(&header->closed))
+        {
+            return false;
+        }
+
+        shm_wait(header, &header->released, &header->released_waiters, released);
+    }
+
+    env_step(ring->envs[slot], shm_ring_actions(ring, slot));
+
+    ring->slot = slot + 1 == header->slot_count ? 0 : slot + 1;
+    shm_publish(&header->published, &header->published_waiters, ++ring->next);
+    return true;
+}
+
+uint32_t shm_ring_acquire(shm_ring_t * ring)
+{
+    assert(ring);
+
+    shm_header_t *header = ring->header;
+
+    for (;;)
+    {
+        const uint32_t published = atomic_load_explicit(&header->published, memory_order_acquire);
+        if ((int32_t)(published - ring->next) > 0)
+        {
+            return ring->slot;
+        }
+
+        if (atomic_load(&header->closed))
+        {
+            return UINT32_MAX;
+        }
+
+        shm_wait(header, &header->published, &header->published_waiters, published);
+    }
+}
+
+void shm_ring_release(shm_ring_t * ring, const uint32_t slot)
+{
+    assert(ring); assert(slot == ring->slot);
+
+    shm_header_t *header = ring->header;
+    ring->slot = slot + 1 == header->slot_count ? 0 : slot + 1;
+    shm_publish(&header->released, &header->released_waiters, ++ring->next);
+}
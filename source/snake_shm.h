@@ -0,0 +1,140 @@
+#pragma once
+
+#include "snake_env.h"
+
+#include <stdatomic.h>
+
+/// batched env served to a trainer in another process through shared
+/// memory, with no copies or serialization on either side.
+///
+/// the mapping holds a ring of slots, each one a whole env batch with its
+/// own observations, rewards, dones and actions. the simulator's env for a
+/// slot writes straight into it. slots are handed over in order: the
+/// simulator publishes a slot, the trainer reads it and writes that slot's
+/// actions, then releases it, and the simulator steps it and publishes it
+/// again. with more than one slot the simulator steps one slot while the
+/// trainer works on the next.
+///
+/// each side waits on a futex over the other side's counter and spins
+/// briefly first. the wake syscall is only made if someone is asleep.
+
+#define SHM_MAGIC 0x524B4E53
+#define SHM_VERSION 1
+
+/// at the start of the mapping. offsets are in bytes, so a trainer in any
+/// language can find every array from the header alone.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t batch;
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t planes;
+    uint32_t slot_count;
+    uint32_t pad;
+
+    /// first slot from the start of the mapping, then every slot_size.
+    uint64_t slot_offset;
+    uint64_t slot_size;
+    /// arrays within a slot. obs is as env_buffers_t, reward float,
+    /// done, truncated and actions one uint8 per game.
+    uint64_t obs_offset;
+    uint64_t reward_offset;
+    uint64_t done_offset;
+    uint64_t truncated_offset;
+    uint64_t action_offset;
+    uint64_t size;
+
+    /// slots published by the simulator and released by the trainer since
+    /// reset, wrapping at 2^32. slots go round in order from 0, so the
+    /// next slot is kept by each side rather than taken from a count.
+    /// own cache lines, one writer each, each with a count of the other
+    /// side asleep waiting on it.
+    _Alignas(64) _Atomic uint32_t published;
+    _Atomic uint32_t published_waiters;
+    _Alignas(64) _Atomic uint32_t released;
+    _Atomic uint32_t released_waiters;
+
+    /// either side may set it, both stop waiting.
+    _Alignas(64) _Atomic uint32_t closed;
+} shm_header_t;
+
+typedef struct
+{
+    shm_header_t *header;
+    uint8_t *base;
+    size_t size;
+    char name[64];
+    /// made the mapping (and unlinks it on close).
+    bool owner;
+
+    /// simulator side, one env per slot.
+    env_t **envs;
+
+    /// handovers this side has made (its counter's value), and the slot
+    /// it hands over (simulator) or takes (trainer) next.
+    uint32_t next;
+    uint32_t slot;
+} shm_ring_t;
+
+/// simulator side. creates the shared memory object name (as shm_open,
+/// "/name"), lays out slot_count slots of config->batch games and makes
+/// an env for each. seed_step is set so no two games share a seed.
+/// fails with errno EEXIST if name is already taken, a ring is never
+/// taken over from a run that may still be going.
+int shm_ring_create(shm_ring_t * ring, const char * name, const env_config_t * config, const uint32_t slot_count);
+
+/// trainer side, maps a ring made by shm_ring_create.
+int shm_ring_open(shm_ring_t * ring, const char * name);
+
+/// stops the other side waiting, then unmaps (and unlinks if owner).
+void shm_ring_close(shm_ring_t * ring);
+
+/// simulator side. resets every game in every slot (game i of slot s
+/// from seed + s * batch + i) and publishes every slot. -1 if a game
+/// can't be made. called once per ring: the trainer's counters can't be
+/// rewound from here, games already reset themselves as they end.
+int shm_ring_reset(shm_ring_t * ring, const uint64_t seed);
+
+/// simulator side. waits for the next slot's actions, steps it and
+/// publishes it. false once the ring is closed.
+bool shm_ring_step(shm_ring_t * ring);
+
+/// trainer side. waits for the next published slot and returns it, with
+/// its observations, rewards and dones ready. UINT32_MAX once closed.
+uint32_t shm_ring_acquire(shm_ring_t * ring);
+
+/// trainer side, once the slot's actions are written. the simulator may
+/// start writing its observations straight away.
+void shm_ring_release(shm_ring_t * ring, const uint32_t slot);
+
+static inline uint8_t * shm_ring_slot(const shm_ring_t * ring, const uint32_t slot)
+{
+    return ring->base + ring->header->slot_offset + slot * ring->header->slot_size;
+}
+
+static inline uint8_t * shm_ring_obs(const shm_ring_t * ring, const uint32_t slot)
+{
+    return shm_ring_slot(ring, slot) + ring->header->obs_offset;
+}
+
+static inline float * shm_ring_reward(const shm_ring_t * ring, const uint32_t slot)
+{
+    return (float *)(shm_ring_slot(ring, slot) + ring->header->reward_offset);
+}
+
+static inline uint8_t * shm_ring_done(const shm_ring_t * ring, const uint32_t slot)
+{
+    return shm_ring_slot(ring, slot) + ring->header->done_offset;
+}
+
+static inline uint8_t * shm_ring_truncated(const shm_ring_t * ring, const uint32_t slot)
+{
+    return shm_ring_slot(ring, slot) + ring->header->truncated_offset;
+}
+
+static inline uint8_t * shm_ring_actions(const shm_ring_t * ring, const uint32_t slot)
+{
+    return shm_ring_slot(ring, slot) + ring->header->action_offset;
+}
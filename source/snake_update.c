@@ -1,6 +1,10 @@
-#include "snake.h"
+#include "snake_core.h"
+#include "snake_replay.h"
+#include "snake_ai.h"
+#include "snake_mcts.h"
 
-#define WRAP(v,x,max) ((((uint16_t)(v + x)) % max))
+/// x may be negative, max is added first so -1 wraps to max - 1.
+#define WRAP(v,x,max) ((uint32_t)(((int64_t)(v) + (x) + (max)) % (max)))
 #define DIRECTION_INVERT(x) (((x + 2) % 4))
 
 static void snake_update_direction(snake_t * snake, const SnakeDirection new_direction)
@@ -17,10 +21,10 @@ static void snake_invert_direction(snake_t * snake)
     assert(snake);
 
     /// swap the body emelments around.
-    for (uint16_t i = 0, sz = snake->size / 2; i < sz; i++)
+    for (uint32_t i = 0, sz = snake->size / 2; i < sz; i++)
     {
-        const uint16_t wrapped_h_pos = WRAP(snake->h_pos, i, snake->size_max);
-        const uint16_t wrapped_t_pos = WRAP(snake->h_pos, -i, snake->size_max);
+        const uint32_t wrapped_h_pos = WRAP(snake->h_pos, i, snake->size_max);
+        const uint32_t wrapped_t_pos = WRAP(snake->h_pos, -(int64_t)i, snake->size_max);
 
         snake_body_t temp_body = snake->body[wrapped_h_pos];
         temp_body.direction = DIRECTION_INVERT(temp_body.direction);
@@ -32,7 +36,7 @@ static void snake_invert_direction(snake_t * snake)
     }
 }
 
-static void snake_new_position(const SnakeDirection direction, uint8_t * x, uint8_t * y)
+static void snake_new_position(const SnakeDirection direction, uint16_t * x, uint16_t * y)
 {
     assert(x); assert(y);
 
@@ -61,40 +65,27 @@ static void snake_move(game_t * game)
     assert(snake_inbounds(game->board, new_head.x, new_head.y));
 
     /// hit detection.
-    switch (game->board->board[new_head.x][new_head.y])
-    {
-        /// hit nothing.
-        case BoardCellType_EMPTY:
-            break;
+    const uint32_t hit = board_bit_index(game->board, new_head.x, new_head.y);
 
-        /// game over.
-        case BoardCellType_WALL: case BoardCellType_SNAKEBODY:
-            game->state = GameState_PAUSE;
-            game->board->board[new_head.x][new_head.y] = BoardCellType_SNAKEHEAD;
-            printf("game over\n");
-            return;
+    /// game over.
+    if (board_blocked(game->board, hit))
+    {
+        game->state = GameState_PAUSE;
+        game->game_over = true;
+        board_set(game->board, new_head.x, new_head.y, BoardCellType_SNAKEHEAD);
+        return;
+    }
 
-        /// eat an item.
-        case BoardCellType_ITEM:
-            for (uint16_t i = 0; i < game->board->item_count; i++)
-            {
-                if (game->board->items[i].x == new_head.x && \
-                    game->board->items[i].y == new_head.y && \
-                    game->board->items[i].type != ItemType_NONE)
-                {
-                    game->snake->t_pos = WRAP(game->snake->t_pos, 1, game->snake->size_max);
-                    game->snake->body[game->snake->t_pos] = old_tail;
-
-                    ++game->snake->size;
-                    --game->board->item_count;
-                    game->board->items[i].type = ItemType_NONE;
-                    break;
-                }
-            }
-            break;
+    /// eat an item.
+    const bool ate = bitboard_test(game->board->bits.sets[BitSet_ITEM], hit);
+    if (ate)
+    {
+        board_remove_item(game->board, new_head.x, new_head.y);
+        game->board->score++;
 
-        default:
-            break;
+        game->snake->t_pos = WRAP(game->snake->t_pos, 1, game->snake->size_max);
+        game->snake->body[game->snake->t_pos] = old_tail;
+        ++game->snake->size;
     }
 
     /// update new head / tail pos in the body array.
@@ -105,14 +96,20 @@ static void snake_move(game_t * game)
     game->snake->body[game->snake->h_pos] = new_head;
 
     /// update new head on the board.
-    game->board->board[new_head.x][new_head.y] = BoardCellType_SNAKEHEAD;
+    board_set(game->board, new_head.x, new_head.y, BoardCellType_SNAKEHEAD);
     /// fill in empty space between body and head on the board.
-    game->board->board[old_head.x][old_head.y] = BoardCellType_SNAKEBODY;
-    /// remove old tail from the board.
-    game->board->board[old_tail.x][old_tail.y] = BoardCellType_EMPTY;
+    board_set(game->board, old_head.x, old_head.y, BoardCellType_SNAKEBODY);
+    /// remove old tail from the board, unless the snake grew and it stays put.
+    /// (clearing it left the tail's cell free, an item could spawn under it
+    /// and be wiped once the tail moved on.)
+    if (!ate)
+    {
+        board_set(game->board, old_tail.x, old_tail.y, BoardCellType_EMPTY);
+    }
 }
 
-static void update_ai(game_t * game)
+/// straight at the newest item, turning away from anything in the way.
+static SnakeDirection ai_greedy(const game_t * game)
 {
     assert(game);
 
@@ -142,38 +139,73 @@ static void update_ai(game_t * game)
         new_direction = SnakeDirection_DOWN;
     }
 
-    /// check what the new x,y position would be.
-    uint8_t new_x = head.x;
-    uint8_t new_y = head.y;
-
     /// check if we are about to hit a wall or eat ourselves
     for (uint8_t i = 0; i < 3; i++)
     {
         /// calculate the new position.
+        uint16_t new_x = head.x;
+        uint16_t new_y = head.y;
         snake_new_position(new_direction, &new_x, &new_y);
-        assert(snake_inbounds(game->board, new_x, new_y));
 
-        if (game->board->board[new_x][new_y] != BoardCellType_WALL && game->board->board[new_x][new_y] != BoardCellType_SNAKEBODY)
+        if (!board_blocked(game->board, board_bit_index(game->board, new_x, new_y)))
         {
             break;
         }
 
-        /// reset the values.
-        new_x = head.x;
-        new_y = head.y;
-
         /// snake cannot invert direction, so we skip the inverted direction.
         new_direction = (head.direction + (i == 2 ? i + 1 : i)) % 4;
     }
 
+    return new_direction;
+}
+
+static void update_ai(game_t * game)
+{
+    assert(game);
+
+    snake_update_direction(game->snake, ai_greedy(game));
+}
+
+/// greedy, but a free cell can still lead into a pocket too small for the
+/// snake, in which case take the move with the most room instead.
+static void update_ai_room(game_t * game)
+{
+    assert(game);
+
+    const snake_body_t head = game->snake->body[game->snake->h_pos];
+    SnakeDirection new_direction = ai_greedy(game);
+
+    uint16_t new_x = head.x;
+    uint16_t new_y = head.y;
+    snake_new_position(new_direction, &new_x, &new_y);
+
+    uint32_t room = board_region_size(game->board, board_bit_index(game->board, new_x, new_y));
+
+    if (room < game->snake->size)
+    {
+        for (uint8_t d = 0; d < 4; d++)
+        {
+            uint16_t x = head.x;
+            uint16_t y = head.y;
+            snake_new_position(d, &x, &y);
+
+            const uint32_t size = board_region_size(game->board, board_bit_index(game->board, x, y));
+            if (size > room)
+            {
+                room = size;
+                new_direction = d;
+            }
+        }
+    }
+
     snake_update_direction(game->snake, new_direction);
 }
 
 static void update_input(game_t * game)
 {
-    if (game->io->type != KeyType_NONE)
+    if (game->input != KeyType_NONE)
     {
-        switch (game->io->type)
+        switch (game->input)
         {
             case KeyType_UP:
                 snake_update_direction(game->snake, SnakeDirection_UP);
@@ -195,46 +227,78 @@ static void update_input(game_t * game)
                 break;
         }
 
-        game->io->type = KeyType_NONE;
+        game->input = KeyType_NONE;
     }
 }
 
-static void update_board(game_t * game)
+bool snake_spawn_items(game_t * game)
 {
     assert(game);
 
-    /// move snake.
-    if (game->frame % game->update_freq == 0)
+    while (game->board->item_count < game->item_goal)
     {
-        if (game->player_type == Player_NORMAL)
-        {
-            update_input(game);
-        }
-        else if (game->player_type == Player_AI)
+        if (!board_gen_rand_item_pos(game->board, &game->rng, ItemType_FOOD))
         {
-            update_ai(game);
-        }
-
-        snake_move(game);
+            /// no room left and nothing to eat, the snake has filled the board.
+            if (game->board->item_count == 0)
+            {
+                game->state = GameState_PAUSE;
+                game->game_over = true;
+                return false;
+            }
 
-        /// create new eat item on board
-        if (game->board->item_count == 0)
-        {
-            board_gen_rand_item_pos(game->board, ItemType_FOOD);
-            game->board->item_count++;
+            break;
         }
     }
+
+    return true;
 }
 
-void snake_update(game_t * game)
+void snake_step(game_t * game)
 {
     assert(game);
 
-    /// update frame count.
-    game->frame = (game->frame + 1) % 60;
+    /// create new eat items on board.
+    /// done before the ai runs so that it always has an item to chase.
+    if (!snake_spawn_items(game))
+    {
+        return;
+    }
+
+    if (game->player_type == Player_NORMAL)
+    {
+        update_input(game);
+    }
+    else if (game->player_type == Player_AI)
+    {
+        update_ai(game);
+    }
+    else if (game->player_type == Player_ROOM)
+    {
+        update_ai_room(game);
+    }
+    else if (game->player_type == Player_PATH)
+    {
+        snake_update_direction(game->snake, snake_ai_path(game));
+    }
+    else if (game->player_type == Player_CYCLE)
+    {
+        snake_update_direction(game->snake, snake_ai_cycle(game));
+    }
+    else if (game->player_type == Player_MCTS)
+    {
+        snake_update_direction(game->snake, snake_ai_mcts(game));
+    }
+    else if (game->player_type == Player_REPLAY)
+    {
+        /// recorded moves were already valid, no need to filter them.
+        game->snake->buffered_direction = replay_next_move(game->replay);
+    }
 
-    if (game->state == GameState_PLAY)
+    if (game->recorder)
     {
-        update_board(game);
+        replay_writer_move(game->recorder, game->snake->buffered_direction);
     }
+
+    snake_move(game);
 }
\ No newline at end of file
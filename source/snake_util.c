@@ -1,30 +1,89 @@
-#include "snake.h"
+#include "snake_core.h"
 
-bool snake_inbounds(board_t * board, const uint8_t x, const uint8_t y)
+#include <unistd.h>
+
+bool snake_inbounds(board_t * board, const uint16_t x, const uint16_t y)
+{
+    return (x < board->rows && y < board->columns);
+}
+
+double snake_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+uint32_t snake_cpu_count(void)
 {
-    return (x < board->columns && y < board->rows);
+    /// -1 if unknown.
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
 }
 
-SnakeDirection snake_gen_rand_direction(void)
+uint64_t snake_parse_seed(const int argc, char * argv[], const int index)
 {
-    return (SnakeDirection)(rand() % 4);
+    assert(argv); assert(index > 0);
+
+    return argc > index ? strtoull(argv[index], NULL, 10) : (uint64_t)time(NULL);
+}
+
+SnakeDirection snake_gen_rand_direction(rng_t * rng)
+{
+    return (SnakeDirection)rng_range(rng, 4);
 }
 
-void board_gen_rand_item_pos(board_t * board, const ItemType type)
+uint32_t board_free_count(const board_t * board)
 {
     assert(board);
 
-    /// FIX: this can cause a pretty big loop if the board is nearly full.
-    uint8_t x = 0, y = 0;
-    do
+    uint32_t count = 0;
+    for (uint32_t w = 0; w < board->bits.words; w++)
     {
-        x = rand() % board->rows;
-        y = rand() % board->columns;
-        assert(snake_inbounds(board, x, y));
-    } while (board->board[x][y] != BoardCellType_EMPTY);
+        count += __builtin_popcountll(board->bits.sets[BitSet_EMPTY][w]);
+    }
 
-    board->board[x][y] = BoardCellType_ITEM;
+    return count;
+}
+
+bool board_gen_rand_item_pos(board_t * board, rng_t * rng, const ItemType type)
+{
+    assert(board); assert(rng);
+
+    if (board->free_count == 0 || board->item_count == board->item_max)
+    {
+        return false;
+    }
+
+    /// pick straight from the free list, no rejection needed.
+    const uint32_t i = board->free_cells[rng_range(rng, board->free_count)];
+    const uint16_t x = i / board->stride - BOARD_PADDING;
+    const uint16_t y = i % board->stride - BOARD_PADDING;
+    assert(snake_inbounds(board, x, y));
+
+    board_set(board, x, y, BoardCellType_ITEM);
     board->items[board->item_count].type = type;
     board->items[board->item_count].x = x;
     board->items[board->item_count].y = y;
+    board->item_at[i] = board->item_count++;
+
+    return true;
+}
+
+board_item_t board_remove_item(board_t * board, const uint16_t x, const uint16_t y)
+{
+    assert(board);
+
+    const uint32_t i = board_bit_index(board, x, y);
+    assert(bitboard_test(board->bits.sets[BitSet_ITEM], i));
+
+    /// move the last item into the hole to keep them packed.
+    const uint32_t slot = board->item_at[i];
+    const board_item_t item = board->items[slot];
+    const board_item_t last = board->items[--board->item_count];
+
+    board->items[slot] = last;
+    board->item_at[board_bit_index(board, last.x, last.y)] = slot;
+
+    return item;
 }
\ No newline at end of file